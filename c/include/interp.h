@@ -5,6 +5,10 @@
 extern "C" {
 #endif
 
+#include <assert.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 #include <interp_ctrl.h>
@@ -14,10 +18,45 @@ extern "C" {
  *  \ingroup hardware_interp
  *
  * Two software interpolator instances compatible with the hardware equivalent:
- * interp0_sw and interp1_sw
+ * interp0_sw and interp1_sw. If the library is built with
+ * INTERP_SW_THREAD_LOCAL_DEFAULTS, they are per thread, so each host thread
+ * simulates the interpolators of its own core.
  */
 
+#ifndef INTERP_SW_CACHE_LINE_SIZE
+#define INTERP_SW_CACHE_LINE_SIZE 64
+#endif
+
+#if !INTERP_SW_THREAD_LOCAL_DEFAULTS
+#define INTERP_SW_THREAD_LOCAL
+#elif defined(__cplusplus)
+#define INTERP_SW_THREAD_LOCAL thread_local
+#else
+#define INTERP_SW_THREAD_LOCAL _Thread_local
+#endif
+
+/*! \brief Operation counters of a simulated interpolator
+ *  \ingroup interp_config
+ *
+ * Only counted if the library is built with INTERP_SW_STATS, see
+ * interp_sw_get_stats().
+ */
 typedef struct {
+    uint64_t updates;       // kernel runs
+    uint64_t redundant;     // kernel runs while all cached results were valid
+    uint64_t pops[3];       // pops of lane 0, lane 1 and full
+    uint64_t writebacks;
+    uint64_t ctrl_changes;  // CTRL configuration changes seen by a kernel run
+    uint64_t overf_changes; // kernel runs that changed the OVERF flags
+} interp_sw_stats_t;
+
+#if INTERP_SW_STATS
+#define INTERP_SW_STATS_COUNT(interp, field, n) ((interp)->stats.field += (n))
+#else
+#define INTERP_SW_STATS_COUNT(interp, field, n) ((void)0)
+#endif
+
+typedef struct interp_sw {
     uint32_t accum[2];
     uint32_t base[3];
     uint32_t ctrl[2];
@@ -25,20 +64,70 @@ typedef struct {
     uint32_t peekraw[2];
     uint16_t index;
     uint16_t generation;
+    uint16_t evaluation;
+    uint16_t stale;
+
+    // update kernel specialized for the current mode, selected whenever the
+    // mode bits of ctrl change or interp_sw_update() is called
+    uint32_t kernel_ctrl[2];
+    uint32_t kernel_mode;
+    void (*kernel)(struct interp_sw *interp, uint32_t results);
+
+#if INTERP_SW_STATS
+    interp_sw_stats_t stats;
+    uint32_t stats_ctrl[2];
+#endif
 } interp_sw_t;
 
-extern interp_sw_t interp0_sw;
-extern interp_sw_t interp1_sw;
+/*! \brief Both simulated interpolators of one core
+ *  \ingroup interp_config
+ *
+ * Aligned to a cache line, so cores simulated on different threads never
+ * share one.
+ */
+typedef struct interp_sw_core {
+    alignas(INTERP_SW_CACHE_LINE_SIZE) interp_sw_t interp[2];
+} interp_sw_core_t;
+
+extern INTERP_SW_THREAD_LOCAL interp_sw_t interp0_sw;
+extern INTERP_SW_THREAD_LOCAL interp_sw_t interp1_sw;
+
+/*! \brief Initialize the simulated interpolators of a core
+ *  \ingroup interp_config
+ *
+ * Resets all registers, sets up interp[0] as the blend capable and interp[1]
+ * as the clamp capable interpolator with eager evaluation.
+ *
+ * \param core Core instance
+ * \param generation INTERP_SW_GENERATION_RP2040 or INTERP_SW_GENERATION_RP2350
+ */
+void interp_sw_core_init(interp_sw_core_t *core, uint32_t generation);
 
 /*! \brief Update the simulated interpolator
  *  \ingroup interp_config
  *
- * Updates the cached results of the simulated interpolator.
+ * Updates the cached results of the simulated interpolator. Call this after
+ * changing the index or generation of an interpolator.
  *
  * \param interp Interpolator instance, interp0 or interp1.
  */
 void interp_sw_update(interp_sw_t *interp);
 
+/*! \brief Update selected results of the simulated interpolator
+ *  \ingroup interp_config
+ *
+ * Updates the cached results selected by the INTERP_SW_RESULT_* bits. With
+ * INTERP_SW_EVALUATION_LAZY, only selected results that are stale are
+ * recomputed. With INTERP_SW_EVALUATION_EAGER, all results are recomputed.
+ *
+ * In lazy mode, call interp_sw_update() after writing the struct fields
+ * directly instead of using the interp_sw_set_...() functions.
+ *
+ * \param interp Interpolator instance, interp0 or interp1.
+ * \param results Bitmask of INTERP_SW_RESULT_* values
+ */
+void interp_sw_update_results(interp_sw_t *interp, uint32_t results);
+
 /*! \brief Trigger the writeback operation on a simulated interpolator
  *  \ingroup interp_config
  *
@@ -48,6 +137,47 @@ void interp_sw_update(interp_sw_t *interp);
  */
 void interp_sw_writeback(interp_sw_t *interp);
 
+/*! \brief Set the evaluation mode of a simulated interpolator
+ *  \ingroup interp_config
+ *
+ * \param interp Interpolator instance, interp0 or interp1.
+ * \param evaluation INTERP_SW_EVALUATION_EAGER or INTERP_SW_EVALUATION_LAZY
+ */
+static inline void interp_sw_set_evaluation(interp_sw_t *interp, uint32_t evaluation) {
+    interp->evaluation = evaluation;
+    interp_sw_update(interp);
+}
+
+/*! \brief Get the operation counters of a simulated interpolator
+ *  \ingroup interp_config
+ *
+ * All counters stay zero unless the library is built with INTERP_SW_STATS.
+ *
+ * \param interp Interpolator instance, interp0 or interp1.
+ * \param stats Pointer to the counters to fill in
+ */
+static inline void interp_sw_get_stats(const interp_sw_t *interp, interp_sw_stats_t *stats) {
+#if INTERP_SW_STATS
+    *stats = interp->stats;
+#else
+    (void)interp;
+    memset(stats, 0, sizeof (interp_sw_stats_t));
+#endif
+}
+
+/*! \brief Reset the operation counters of a simulated interpolator
+ *  \ingroup interp_config
+ *
+ * \param interp Interpolator instance, interp0 or interp1.
+ */
+static inline void interp_sw_reset_stats(interp_sw_t *interp) {
+#if INTERP_SW_STATS
+    memset(&interp->stats, 0, sizeof (interp_sw_stats_t));
+#else
+    (void)interp;
+#endif
+}
+
 /** \brief Interpolator configuration
  *  \defgroup interp_config interp_config
  *  \ingroup hardware_interp
@@ -251,6 +381,7 @@ static inline interp_sw_config_t interp_sw_default_config(void) {
 
 static inline void interp_sw_set_config(interp_sw_t *interp, uint32_t lane, interp_sw_config_t *config) {
     interp->ctrl[lane] = interp_sw_config_to_reg(config);
+    interp->stale = INTERP_SW_RESULT_ALL;
 }
 
 /*! \brief Directly set the force bits on a specified lane
@@ -269,6 +400,7 @@ static inline void interp_sw_set_config(interp_sw_t *interp, uint32_t lane, inte
 static inline void interp_sw_set_force_bits(interp_sw_t *interp, uint32_t lane, uint32_t bits) {
     // note cannot use hw_set_bits on SIO
     interp->ctrl[lane] = interp->ctrl[lane] | (bits << INTERP_SW_CTRL_LANE0_FORCE_MSB_LSB);
+    interp->stale = INTERP_SW_RESULT_ALL;
 }
 
 typedef struct {
@@ -307,6 +439,7 @@ void interp_sw_restore(interp_sw_t *interp, interp_sw_save_t *saver);
  */
 static inline void interp_sw_set_base(interp_sw_t *interp, uint32_t lane, uint32_t val) {
     interp->base[lane] = val;
+    interp->stale |= INTERP_SW_RESULT_LANE0 | INTERP_SW_RESULT_LANE1 | INTERP_SW_RESULT_FULL;
 }
 
 /*! \brief Gets the content of interpolator base register by lane
@@ -341,6 +474,7 @@ void interp_sw_set_base_both(interp_sw_t *interp, uint32_t val);
  */
 static inline void interp_sw_set_accumulator(interp_sw_t *interp, uint32_t lane, uint32_t val) {
     interp->accum[lane] = val;
+    interp->stale = INTERP_SW_RESULT_ALL;
 }
 
 /*! \brief Gets the content of the interpolator accumulator register by lane
@@ -362,7 +496,8 @@ static inline uint32_t interp_sw_get_accumulator(interp_sw_t *interp, uint32_t l
  * \return The content of the lane result register
  */
 static inline uint32_t interp_sw_pop_lane_result(interp_sw_t *interp, uint32_t lane) {
-    interp_sw_update(interp);
+    interp_sw_update_results(interp, INTERP_SW_RESULT_LANE0 | INTERP_SW_RESULT_LANE1);
+    INTERP_SW_STATS_COUNT(interp, pops[lane], 1);
     uint32_t result = interp->peek[lane];
     interp_sw_writeback(interp);
     return result;
@@ -376,7 +511,7 @@ static inline uint32_t interp_sw_pop_lane_result(interp_sw_t *interp, uint32_t l
  * \return The content of the lane result register
  */
 static inline uint32_t interp_sw_peek_lane_result(interp_sw_t *interp, uint32_t lane) {
-    interp_sw_update(interp);
+    interp_sw_update_results(interp, INTERP_SW_RESULT_LANE0 << lane);
     return interp->peek[lane];
 }
 
@@ -387,7 +522,8 @@ static inline uint32_t interp_sw_peek_lane_result(interp_sw_t *interp, uint32_t
  * \return The content of the FULL register
  */
 static inline uint32_t interp_sw_pop_full_result(interp_sw_t *interp) {
-    interp_sw_update(interp);
+    interp_sw_update_results(interp, INTERP_SW_RESULT_LANE0 | INTERP_SW_RESULT_LANE1 | INTERP_SW_RESULT_FULL);
+    INTERP_SW_STATS_COUNT(interp, pops[2], 1);
     uint32_t result = interp->peek[2];
     interp_sw_writeback(interp);
     return result;
@@ -400,10 +536,65 @@ static inline uint32_t interp_sw_pop_full_result(interp_sw_t *interp) {
  * \return The content of the FULL register
  */
 static inline uint32_t interp_sw_peek_full_result(interp_sw_t *interp) {
-    interp_sw_update(interp);
+    interp_sw_update_results(interp, INTERP_SW_RESULT_FULL);
     return interp->peek[2];
 }
 
+/*! \brief Pop a lane result n times
+ *  \ingroup hardware_interp
+ *
+ * Same as calling interp_sw_pop_lane_result() n times, but decodes the
+ * interpolator settings only once. Other lane numbers are an error: they
+ * assert, or do nothing if assertions are disabled.
+ *
+ * \param interp Interpolator instance, interp0 or interp1.
+ * \param lane The lane number, 0 or 1
+ * \param out Array of n results
+ * \param n Number of pops
+ */
+void interp_sw_pop_lane_results(interp_sw_t *interp, uint32_t lane, uint32_t *out, size_t n);
+
+/*! \brief Pop the FULL result n times
+ *  \ingroup hardware_interp
+ *
+ * Same as calling interp_sw_pop_full_result() n times, but decodes the
+ * interpolator settings only once.
+ *
+ * \param interp Interpolator instance, interp0 or interp1.
+ * \param out Array of n results
+ * \param n Number of pops
+ */
+void interp_sw_pop_full_results(interp_sw_t *interp, uint32_t *out, size_t n);
+
+/*! \brief Read both lane results and pop, n times
+ *  \ingroup hardware_interp
+ *
+ * Same as n times reading PEEK_LANE0 followed by POP_LANE1, storing the
+ * results interleaved.
+ *
+ * \param interp Interpolator instance, interp0 or interp1.
+ * \param out Array of 2 * n results, lane 0 at even and lane 1 at odd indices
+ * \param n Number of pops
+ */
+void interp_sw_pop_both_lane_results(interp_sw_t *interp, uint32_t *out, size_t n);
+
+/*! \brief Add to an accumulator and pop a lane result, n times
+ *  \ingroup hardware_interp
+ *
+ * Same as calling interp_sw_add_accumulator() with vals[k] followed by
+ * interp_sw_pop_lane_result() for each k, but decodes the interpolator
+ * settings only once. Other lane numbers are an error: they assert, or do
+ * nothing if assertions are disabled.
+ *
+ * \param interp Interpolator instance, interp0 or interp1.
+ * \param add_lane The accumulator to add to, 0 or 1
+ * \param vals Array of n values to add
+ * \param pop_lane The lane to pop, 0 or 1
+ * \param out Array of n results
+ * \param n Number of pops
+ */
+void interp_sw_add_pop_lane_results(interp_sw_t *interp, uint32_t add_lane, const uint32_t *vals, uint32_t pop_lane, uint32_t *out, size_t n);
+
 /*! \brief Add to accumulator
  *  \ingroup hardware_interp
  *
@@ -415,6 +606,7 @@ static inline uint32_t interp_sw_peek_full_result(interp_sw_t *interp) {
  */
 static inline void interp_sw_add_accumulator(interp_sw_t *interp, uint32_t lane, uint32_t val) {
     interp->accum[lane] += val;
+    interp->stale = INTERP_SW_RESULT_ALL;
 }
 
 /*! \brief Get raw lane value
@@ -427,7 +619,7 @@ static inline void interp_sw_add_accumulator(interp_sw_t *interp, uint32_t lane,
  * \return The raw shift/mask value
  */
 static inline uint32_t interp_sw_get_raw(interp_sw_t *interp, uint32_t lane) {
-    interp_sw_update(interp);
+    interp_sw_update_results(interp, INTERP_SW_RESULT_RAW0 << lane);
     return interp->peekraw[lane];
 }
 
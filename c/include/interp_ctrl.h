@@ -22,6 +22,23 @@ extern "C" {
 #define INTERP_SW_GENERATION_DEFAULT INTERP_SW_GENERATION_RP2040
 #endif
 #endif
+// -----------------------------------------------------------------------------
+// Register    : INTERP_SW_EVALUATION
+// Description : Describes when the cached results are recomputed.
+//               EAGER recomputes all results on every update.
+//               LAZY only marks results as stale on writes and recomputes the
+//               requested results on read.
+#define INTERP_SW_EVALUATION_EAGER 0
+#define INTERP_SW_EVALUATION_LAZY 1
+// -----------------------------------------------------------------------------
+// Register    : INTERP_SW_RESULT
+// Description : Selects cached results of the simulated interpolator
+#define INTERP_SW_RESULT_LANE0 0x01u
+#define INTERP_SW_RESULT_LANE1 0x02u
+#define INTERP_SW_RESULT_FULL  0x04u
+#define INTERP_SW_RESULT_RAW0  0x08u
+#define INTERP_SW_RESULT_RAW1  0x10u
+#define INTERP_SW_RESULT_ALL   0x1fu
 // =============================================================================
 
 // =============================================================================
@@ -0,0 +1,146 @@
+#ifndef YRLF_C_INTERP_VECTOR_H_
+#define YRLF_C_INTERP_VECTOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <interp.h>
+
+/** \brief Test vector corpus
+ *  \defgroup interp_vector interp_vector
+ *
+ * A corpus file is an interp_vector_header_t followed by
+ * INTERP_VECTOR_COLUMN_COUNT columns of count little endian uint32_t values
+ * each, so a memory-mapped file can be read without copying.
+ *
+ * Each vector restores the writable registers of its before state on
+ * interpolator n, performs one register write or read, and expects the read
+ * value and the after state.
+ */
+
+#define INTERP_VECTOR_VERSION 1
+
+// register ids, same order as InterpReg in the test library
+#define INTERP_VECTOR_REG_ACCUM0   0
+#define INTERP_VECTOR_REG_ACCUM1   1
+#define INTERP_VECTOR_REG_BASE0    2
+#define INTERP_VECTOR_REG_BASE1    3
+#define INTERP_VECTOR_REG_BASE2    4
+#define INTERP_VECTOR_REG_CTRL0    5
+#define INTERP_VECTOR_REG_CTRL1    6
+#define INTERP_VECTOR_REG_POP0     7
+#define INTERP_VECTOR_REG_POP1     8
+#define INTERP_VECTOR_REG_POP2     9
+#define INTERP_VECTOR_REG_PEEK0    10
+#define INTERP_VECTOR_REG_PEEK1    11
+#define INTERP_VECTOR_REG_PEEK2    12
+#define INTERP_VECTOR_REG_PEEKRAW0 13
+#define INTERP_VECTOR_REG_PEEKRAW1 14
+#define INTERP_VECTOR_REG_ADD0     15
+#define INTERP_VECTOR_REG_ADD1     16
+#define INTERP_VECTOR_REG_BASE01   17
+
+// op column: interp num in bit 0, write in bit 1, register id in bits 15:8
+#define INTERP_VECTOR_OP_N_BITS     0x00000001u
+#define INTERP_VECTOR_OP_WRITE_BITS 0x00000002u
+#define INTERP_VECTOR_OP_REG_BITS   0x0000ff00u
+#define INTERP_VECTOR_OP_REG_LSB    8u
+
+// columns, states in interp_sw_save_t order
+#define INTERP_VECTOR_COLUMN_OP     0
+#define INTERP_VECTOR_COLUMN_VALUE  1
+#define INTERP_VECTOR_COLUMN_BEFORE 2
+#define INTERP_VECTOR_COLUMN_AFTER  14
+#define INTERP_VECTOR_STATE_COLUMNS 12
+#define INTERP_VECTOR_COLUMN_COUNT  26
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint8_t generation;
+    uint8_t column_count;
+    uint64_t count;
+    uint8_t _reserved0[16];
+} interp_vector_header_t;
+
+typedef struct {
+    uint64_t count;
+    uint32_t generation;
+    const uint32_t *columns[INTERP_VECTOR_COLUMN_COUNT];
+} interp_vector_file_t;
+
+typedef struct {
+    uint32_t n;
+    uint32_t reg;
+    bool write;
+    uint32_t value;
+    interp_sw_save_t before;
+    interp_sw_save_t after;
+} interp_vector_t;
+
+/*! \brief Open a corpus in memory
+ *  \ingroup interp_vector
+ *
+ * Checks the header and sets up the column pointers, the data is not copied
+ * and must stay mapped while the file is used.
+ *
+ * \param file Corpus to set up
+ * \param data Start of the corpus, aligned to 4 bytes
+ * \param size Size of the corpus in bytes
+ * \return false if the header, version or size is invalid
+ */
+static inline bool interp_vector_open(interp_vector_file_t *file, const void *data, size_t size) {
+    static_assert(sizeof (interp_vector_header_t) == 32, "interp_vector_header_t has invalid layout");
+    static_assert(sizeof (interp_sw_save_t) == INTERP_VECTOR_STATE_COLUMNS * sizeof (uint32_t), "interp_sw_save_t has invalid layout");
+
+    interp_vector_header_t header;
+    if (size < sizeof header) return false;
+    memcpy(&header, data, sizeof header);
+
+    if (memcmp(header.magic, "IVEC", 4) != 0) return false;
+    if (header.version != INTERP_VECTOR_VERSION || header.column_count != INTERP_VECTOR_COLUMN_COUNT) return false;
+    if ((size - sizeof header) / sizeof (uint32_t) / INTERP_VECTOR_COLUMN_COUNT < header.count) return false;
+
+    const uint32_t *columns = (const uint32_t *)((const char *)data + sizeof header);
+
+    file->count = header.count;
+    file->generation = header.generation;
+    for (size_t i = 0; i < INTERP_VECTOR_COLUMN_COUNT; i++) {
+        file->columns[i] = columns + i * header.count;
+    }
+    return true;
+}
+
+/*! \brief Get one vector of a corpus
+ *  \ingroup interp_vector
+ *
+ * \param file Opened corpus
+ * \param i Index of the vector, less than file->count
+ * \param vector Vector to fill in
+ */
+static inline void interp_vector_get(const interp_vector_file_t *file, uint64_t i, interp_vector_t *vector) {
+    uint32_t op = file->columns[INTERP_VECTOR_COLUMN_OP][i];
+    vector->n = op & INTERP_VECTOR_OP_N_BITS;
+    vector->write = op & INTERP_VECTOR_OP_WRITE_BITS;
+    vector->reg = (op & INTERP_VECTOR_OP_REG_BITS) >> INTERP_VECTOR_OP_REG_LSB;
+    vector->value = file->columns[INTERP_VECTOR_COLUMN_VALUE][i];
+
+    uint32_t before[INTERP_VECTOR_STATE_COLUMNS], after[INTERP_VECTOR_STATE_COLUMNS];
+    for (size_t k = 0; k < INTERP_VECTOR_STATE_COLUMNS; k++) {
+        before[k] = file->columns[INTERP_VECTOR_COLUMN_BEFORE + k][i];
+        after[k] = file->columns[INTERP_VECTOR_COLUMN_AFTER + k][i];
+    }
+    memcpy(&vector->before, before, sizeof before);
+    memcpy(&vector->after, after, sizeof after);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,90 +1,338 @@
 #include <interp.h>
 #include <interp_ctrl.h>
 
-interp_sw_t interp0_sw = { .index = INTERP_SW_INDEX_BLEND_CAPABLE, .generation = INTERP_SW_GENERATION_DEFAULT };
-interp_sw_t interp1_sw = { .index = INTERP_SW_INDEX_CLAMP_CAPABLE, .generation = INTERP_SW_GENERATION_DEFAULT };
+INTERP_SW_THREAD_LOCAL interp_sw_t interp0_sw = { .index = INTERP_SW_INDEX_BLEND_CAPABLE, .generation = INTERP_SW_GENERATION_DEFAULT };
+INTERP_SW_THREAD_LOCAL interp_sw_t interp1_sw = { .index = INTERP_SW_INDEX_CLAMP_CAPABLE, .generation = INTERP_SW_GENERATION_DEFAULT };
+
+#if defined(__GNUC__)
+#define INTERP_SW_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define INTERP_SW_ALWAYS_INLINE inline
+#endif
+
+// CTRL, index and generation settings a kernel is specialized for
+#define INTERP_SW_MODE_BLEND 0x01u
+#define INTERP_SW_MODE_CLAMP 0x02u
+#define INTERP_SW_MODE_RP2350 0x04u
+#define INTERP_SW_MODE_SIGNED0 0x08u
+#define INTERP_SW_MODE_SIGNED1 0x10u
+
+// CTRL bits without the OVERF flags
+#define INTERP_SW_CONFIG_BITS 0x007fffffu
+
+// CTRL bits of the lane settings, without blend, clamp and the OVERF flags
+#define INTERP_SW_LANE_BITS 0x001fffffu
+
+// CTRL bits a kernel selection depends on
+#define INTERP_SW_MODE_CTRL0_BITS (INTERP_SW_CTRL_LANE0_SIGNED_BITS | INTERP_SW_CTRL_LANE0_BLEND_BITS | INTERP_SW_CTRL_LANE0_CLAMP_BITS)
+#define INTERP_SW_MODE_CTRL1_BITS (INTERP_SW_CTRL_LANE0_SIGNED_BITS)
+
+// settings of one lane decoded from CTRL
+typedef struct {
+    uint32_t mask;
+    uint32_t sign_bit;
+    uint32_t sext_mask;
+    uint32_t force_bits;
+    uint32_t shift;
+    uint32_t input;
+    uint32_t writeback;
+    bool add_raw;
+} interp_sw_lane_plan_t;
+
+static INTERP_SW_ALWAYS_INLINE void interp_sw_lane_plan(interp_sw_lane_plan_t *lane, uint32_t ctrl, bool cross_input, bool cross_result) {
+    interp_sw_config_t c;
+    interp_sw_config_from_reg(&c, ctrl);
+
+    uint32_t top = (1LL << (c.mask_msb + 1)) - 1;
+
+    lane->mask = top & ~((1LL << c.mask_lsb) - 1);
+    lane->sign_bit = 1U << c.mask_msb;
+    lane->sext_mask = ~top;
+    lane->force_bits = c.force_msb << 28;
+    lane->shift = c.shift;
+    lane->input = cross_input;
+    lane->writeback = cross_result;
+    lane->add_raw = c.add_raw;
+}
+
+// lane 1 selects its input and writeback with inverted cross bits
+static INTERP_SW_ALWAYS_INLINE void interp_sw_plan(const interp_sw_t *interp, interp_sw_lane_plan_t *lane0, interp_sw_lane_plan_t *lane1) {
+    interp_sw_lane_plan(lane0, interp->ctrl[0], interp->ctrl[0] & INTERP_SW_CTRL_LANE0_CROSS_INPUT_BITS, interp->ctrl[0] & INTERP_SW_CTRL_LANE0_CROSS_RESULT_BITS);
+    interp_sw_lane_plan(lane1, interp->ctrl[1], !(interp->ctrl[1] & INTERP_SW_CTRL_LANE0_CROSS_INPUT_BITS), !(interp->ctrl[1] & INTERP_SW_CTRL_LANE0_CROSS_RESULT_BITS));
+}
+
+// the datapath of update and of the batch kernels, one function per result
+
+static INTERP_SW_ALWAYS_INLINE uint32_t interp_sw_lane_raw(const interp_sw_lane_plan_t *lane, uint32_t input, bool rp2350, bool is_signed, bool *overf) {
+    uint32_t shift;
+    if (rp2350) {
+        shift = (input >> lane->shift) | ((uint64_t)input << (32 - lane->shift));
+    } else {
+        shift = input >> lane->shift;
+    }
+
+    *overf = (shift & lane->sext_mask) != 0;
+    uint32_t result = shift & lane->mask;
+    return (is_signed && (shift & lane->sign_bit)) ? result | lane->sext_mask : result;
+}
+
+static INTERP_SW_ALWAYS_INLINE uint32_t interp_sw_lane0_result(const interp_sw_lane_plan_t *lane0, uint32_t mode, uint32_t base0, uint32_t base1, uint32_t input0, uint32_t raw0, uint32_t raw1) {
+    uint32_t addresult0 = base0 + (lane0->add_raw ? input0 : raw0);
+
+    uint32_t uclamp0 = raw0 < base0 ? base0 : (raw0 > base1 ? base1 : raw0);
+    uint32_t sclamp0 = (int32_t)raw0 < (int32_t)base0 ? base0 : ((int32_t)raw0 > (int32_t)base1 ? base1 : raw0);
+    uint32_t clamp0 = (mode & INTERP_SW_MODE_SIGNED0) ? sclamp0 : uclamp0;
+
+    uint8_t alpha1 = raw1;
+    return (mode & INTERP_SW_MODE_BLEND) ? alpha1 : ((mode & INTERP_SW_MODE_CLAMP) ? clamp0 : addresult0) | lane0->force_bits;
+}
+
+static INTERP_SW_ALWAYS_INLINE uint32_t interp_sw_lane1_result(const interp_sw_lane_plan_t *lane1, uint32_t mode, uint32_t base0, uint32_t base1, uint32_t input1, uint32_t raw1) {
+    uint32_t addresult1 = base1 + (lane1->add_raw ? input1 : raw1);
+
+    uint8_t alpha1 = raw1;
+    uint32_t ublend1 = base0 + (alpha1 * ((uint64_t)base1 - (uint64_t)base0) >> 8);
+    uint32_t sblend1 = base0 + (alpha1 * ((int64_t)(int32_t)base1 - (int64_t)(int32_t)base0) >> 8);
+    uint32_t blend1 = (mode & INTERP_SW_MODE_SIGNED1) ? sblend1 : ublend1;
+
+    return ((mode & INTERP_SW_MODE_BLEND) ? blend1 : addresult1) | lane1->force_bits;
+}
+
+static INTERP_SW_ALWAYS_INLINE uint32_t interp_sw_full_result(uint32_t mode, uint32_t base2, uint32_t raw0, uint32_t raw1) {
+    return base2 + raw0 + ((mode & INTERP_SW_MODE_BLEND) ? 0 : raw1);
+}
+
+static INTERP_SW_ALWAYS_INLINE void interp_sw_compute(interp_sw_t *interp, uint32_t results, uint32_t mode) {
+    interp_sw_lane_plan_t lane0, lane1;
+    interp_sw_plan(interp, &lane0, &lane1);
+
+    bool rp2350 = mode & INTERP_SW_MODE_RP2350;
+    uint32_t input0 = interp->accum[lane0.input];
+    uint32_t input1 = interp->accum[lane1.input];
+
+    // the OVERF flags of a lane that is not computed are kept
+    bool overf0 = interp->ctrl[0] & INTERP_SW_CTRL_LANE0_OVERF0_BITS;
+    bool overf1 = interp->ctrl[0] & INTERP_SW_CTRL_LANE0_OVERF1_BITS;
+    if (results & INTERP_SW_RESULT_RAW0) interp->peekraw[0] = interp_sw_lane_raw(&lane0, input0, rp2350, mode & INTERP_SW_MODE_SIGNED0, &overf0);
+    if (results & INTERP_SW_RESULT_RAW1) interp->peekraw[1] = interp_sw_lane_raw(&lane1, input1, rp2350, mode & INTERP_SW_MODE_SIGNED1, &overf1);
+
+    uint32_t ctrl0 = (interp->ctrl[0] & INTERP_SW_LANE_BITS)
+        | ((mode & INTERP_SW_MODE_BLEND) ? INTERP_SW_CTRL_LANE0_BLEND_BITS : 0)
+        | ((mode & INTERP_SW_MODE_CLAMP) ? INTERP_SW_CTRL_LANE0_CLAMP_BITS : 0)
+        | (overf0 ? INTERP_SW_CTRL_LANE0_OVERF0_BITS : 0)
+        | (overf1 ? INTERP_SW_CTRL_LANE0_OVERF1_BITS : 0)
+        | ((overf0 || overf1) ? INTERP_SW_CTRL_LANE0_OVERF_BITS : 0);
+#if INTERP_SW_STATS
+    uint32_t overf_bits = INTERP_SW_CTRL_LANE0_OVERF0_BITS | INTERP_SW_CTRL_LANE0_OVERF1_BITS;
+    INTERP_SW_STATS_COUNT(interp, overf_changes, ((interp->ctrl[0] ^ ctrl0) & overf_bits) != 0);
+#endif
+    interp->ctrl[0] = ctrl0;
+    interp->ctrl[1] &= INTERP_SW_LANE_BITS;
+
+    uint32_t raw0 = interp->peekraw[0];
+    uint32_t raw1 = interp->peekraw[1];
+
+    if (results & INTERP_SW_RESULT_LANE0) interp->peek[0] = interp_sw_lane0_result(&lane0, mode, interp->base[0], interp->base[1], input0, raw0, raw1);
+    if (results & INTERP_SW_RESULT_LANE1) interp->peek[1] = interp_sw_lane1_result(&lane1, mode, interp->base[0], interp->base[1], input1, raw1);
+    if (results & INTERP_SW_RESULT_FULL) interp->peek[2] = interp_sw_full_result(mode, interp->base[2], raw0, raw1);
+}
+
+// one kernel per mode, generated from the mode bits (blend is the lowest bit)
+#define INTERP_SW_KERNELS(X) INTERP_SW_KERNELS_4(X, 0) INTERP_SW_KERNELS_4(X, 1)
+#define INTERP_SW_KERNELS_4(X, a) INTERP_SW_KERNELS_3(X, a, 0) INTERP_SW_KERNELS_3(X, a, 1)
+#define INTERP_SW_KERNELS_3(X, a, b) INTERP_SW_KERNELS_2(X, a, b, 0) INTERP_SW_KERNELS_2(X, a, b, 1)
+#define INTERP_SW_KERNELS_2(X, a, b, c) INTERP_SW_KERNELS_1(X, a, b, c, 0) INTERP_SW_KERNELS_1(X, a, b, c, 1)
+#define INTERP_SW_KERNELS_1(X, a, b, c, d) X(a, b, c, d, 0) X(a, b, c, d, 1)
+
+#define INTERP_SW_KERNEL_DEFINE(a, b, c, d, e) \
+    static void interp_sw_kernel_##a##b##c##d##e(interp_sw_t *interp, uint32_t results) { \
+        interp_sw_compute(interp, results, (a << 4) | (b << 3) | (c << 2) | (d << 1) | e); \
+    }
+#define INTERP_SW_KERNEL_ENTRY(a, b, c, d, e) interp_sw_kernel_##a##b##c##d##e,
+
+INTERP_SW_KERNELS(INTERP_SW_KERNEL_DEFINE)
+
+static void (*const interp_sw_kernels[32])(interp_sw_t *interp, uint32_t results) = {
+    INTERP_SW_KERNELS(INTERP_SW_KERNEL_ENTRY)
+};
+
+// pops n times from lane pop (0, 1, 2 for FULL, or 3 for both lanes
+// interleaved), adding vals[k] to accumulator add_lane before pop k if vals
+// is not NULL
+static INTERP_SW_ALWAYS_INLINE void interp_sw_batch(interp_sw_t *interp, uint32_t mode, uint32_t pop, uint32_t add_lane, const uint32_t *vals, uint32_t *out, size_t n) {
+    interp_sw_lane_plan_t lane0, lane1;
+    interp_sw_plan(interp, &lane0, &lane1);
+
+    bool rp2350 = mode & INTERP_SW_MODE_RP2350;
+
+    // local copies, so stores to out cannot alias the interpolator state
+    const uint32_t base0 = interp->base[0];
+    const uint32_t base1 = interp->base[1];
+    const uint32_t base2 = interp->base[2];
+    uint32_t accum[2] = { interp->accum[0], interp->accum[1] };
+
+    for (size_t k = 0; k < n; k++) {
+        if (vals != NULL) accum[add_lane] += vals[k];
+
+        uint32_t input0 = accum[lane0.input];
+        uint32_t input1 = accum[lane1.input];
+        bool overf0, overf1;
+        uint32_t raw0 = interp_sw_lane_raw(&lane0, input0, rp2350, mode & INTERP_SW_MODE_SIGNED0, &overf0);
+        uint32_t raw1 = interp_sw_lane_raw(&lane1, input1, rp2350, mode & INTERP_SW_MODE_SIGNED1, &overf1);
+        uint32_t result[2] = {
+            interp_sw_lane0_result(&lane0, mode, base0, base1, input0, raw0, raw1),
+            interp_sw_lane1_result(&lane1, mode, base0, base1, input1, raw1),
+        };
+
+        switch (pop) {
+            case 0: out[k] = result[0]; break;
+            case 1: out[k] = result[1]; break;
+            case 2: out[k] = interp_sw_full_result(mode, base2, raw0, raw1); break;
+            case 3: out[2 * k] = result[0]; out[2 * k + 1] = result[1]; break;
+        }
+
+        accum[0] = result[lane0.writeback];
+        accum[1] = result[lane1.writeback];
+    }
+
+    interp->accum[0] = accum[0];
+    interp->accum[1] = accum[1];
+}
+
+#define INTERP_SW_BATCH_DEFINE(a, b, c, d, e) \
+    static void interp_sw_batch_##a##b##c##d##e(interp_sw_t *interp, uint32_t pop, uint32_t add_lane, const uint32_t *vals, uint32_t *out, size_t n) { \
+        interp_sw_batch(interp, (a << 4) | (b << 3) | (c << 2) | (d << 1) | e, pop, add_lane, vals, out, n); \
+    }
+#define INTERP_SW_BATCH_ENTRY(a, b, c, d, e) interp_sw_batch_##a##b##c##d##e,
+
+INTERP_SW_KERNELS(INTERP_SW_BATCH_DEFINE)
+
+static void (*const interp_sw_batch_kernels[32])(interp_sw_t *interp, uint32_t pop, uint32_t add_lane, const uint32_t *vals, uint32_t *out, size_t n) = {
+    INTERP_SW_KERNELS(INTERP_SW_BATCH_ENTRY)
+};
+
+static void interp_sw_select_kernel(interp_sw_t *interp) {
+    uint32_t ctrl0 = interp->ctrl[0];
+    uint32_t ctrl1 = interp->ctrl[1];
+
+    uint32_t mode = 0;
+    if ((ctrl0 & INTERP_SW_CTRL_LANE0_BLEND_BITS) && interp->index == INTERP_SW_INDEX_BLEND_CAPABLE) mode |= INTERP_SW_MODE_BLEND;
+    if ((ctrl0 & INTERP_SW_CTRL_LANE0_CLAMP_BITS) && interp->index == INTERP_SW_INDEX_CLAMP_CAPABLE) mode |= INTERP_SW_MODE_CLAMP;
+    if (interp->generation == INTERP_SW_GENERATION_RP2350) mode |= INTERP_SW_MODE_RP2350;
+    if (ctrl0 & INTERP_SW_CTRL_LANE0_SIGNED_BITS) mode |= INTERP_SW_MODE_SIGNED0;
+    if (ctrl1 & INTERP_SW_CTRL_LANE0_SIGNED_BITS) mode |= INTERP_SW_MODE_SIGNED1;
+
+    interp->kernel_ctrl[0] = ctrl0 & INTERP_SW_MODE_CTRL0_BITS;
+    interp->kernel_ctrl[1] = ctrl1 & INTERP_SW_MODE_CTRL1_BITS;
+    interp->kernel_mode = mode;
+    interp->kernel = interp_sw_kernels[mode];
+}
+
+#if INTERP_SW_STATS
+// true if CTRL changed since the last kernel run, ignoring OVERF flags
+static bool interp_sw_stats_ctrl_changed(const interp_sw_t *interp) {
+    return (interp->ctrl[0] & INTERP_SW_CONFIG_BITS) != interp->stats_ctrl[0]
+        || (interp->ctrl[1] & INTERP_SW_CONFIG_BITS) != interp->stats_ctrl[1];
+}
+#endif
+
+void interp_sw_core_init(interp_sw_core_t *core, uint32_t generation) {
+    memset(core, 0, sizeof (interp_sw_core_t));
+
+    for (uint16_t i = 0; i < 2; i++) {
+        core->interp[i].index = i;
+        core->interp[i].generation = generation;
+        core->interp[i].evaluation = INTERP_SW_EVALUATION_EAGER;
+        interp_sw_update(&core->interp[i]);
+    }
+}
 
 void interp_sw_update(interp_sw_t *interp) {
-    interp_sw_config_t ctrl0, ctrl1;
-    interp_sw_config_from_reg(&ctrl0, interp->ctrl[0]);
-    interp_sw_config_from_reg(&ctrl1, interp->ctrl[1]);
+    interp_sw_select_kernel(interp);
+#if INTERP_SW_STATS
+    INTERP_SW_STATS_COUNT(interp, redundant, interp->stale == 0 && !interp_sw_stats_ctrl_changed(interp));
+#endif
+    interp->stale = INTERP_SW_RESULT_ALL;
+    interp_sw_update_results(interp, INTERP_SW_RESULT_ALL);
+}
 
-    bool do_clamp = (ctrl0.clamp && interp->index == INTERP_SW_INDEX_CLAMP_CAPABLE);
-    bool do_blend = (ctrl1.blend && interp->index == INTERP_SW_INDEX_BLEND_CAPABLE);
-
-    ctrl0.clamp = do_clamp;
-    ctrl0.blend = do_blend;
-    ctrl0._reserved0 = 0;
-    ctrl1.clamp = 0;
-    ctrl1.blend = 0;
-    ctrl1.overf0 = 0;
-    ctrl1.overf1 = 0;
-    ctrl1.overf = 0;
-    ctrl1._reserved0 = 0;
-
-    uint32_t input0 = interp->accum[ctrl0.cross_input ? 1 : 0];
-    uint32_t input1 = interp->accum[ctrl1.cross_input ? 0 : 1];
-
-    uint32_t mask0 = ((1LL << (ctrl0.mask_msb + 1)) - 1) & ~((1LL << ctrl0.mask_lsb) - 1);
-    uint32_t mask1 = ((1LL << (ctrl1.mask_msb + 1)) - 1) & ~((1LL << ctrl1.mask_lsb) - 1);
-
-    uint32_t shift0;
-    uint32_t shift1;
-    switch (interp->generation) {
-        default:
-        case INTERP_SW_GENERATION_RP2040:
-            shift0 = input0 >> ctrl0.shift;
-            shift1 = input1 >> ctrl1.shift;
-            break;
-        case INTERP_SW_GENERATION_RP2350:
-            shift0 = (input0 >> ctrl0.shift) | ((uint64_t)input0 << (32 - ctrl0.shift));
-            shift1 = (input1 >> ctrl1.shift) | ((uint64_t)input1 << (32 - ctrl1.shift));
-            break;
+// selects the kernel again if the mode bits of ctrl changed
+static void interp_sw_refresh_kernel(interp_sw_t *interp) {
+    if (interp->kernel == NULL
+        || (interp->ctrl[0] & INTERP_SW_MODE_CTRL0_BITS) != interp->kernel_ctrl[0]
+        || (interp->ctrl[1] & INTERP_SW_MODE_CTRL1_BITS) != interp->kernel_ctrl[1]) {
+        interp_sw_select_kernel(interp);
     }
+}
 
-    uint32_t uresult0 = shift0 & mask0;
-    uint32_t uresult1 = shift1 & mask1;
+void interp_sw_update_results(interp_sw_t *interp, uint32_t results) {
+    interp_sw_refresh_kernel(interp);
 
-    bool overf0 = shift0 & ~((1LL << (ctrl0.mask_msb + 1)) - 1);
-    bool overf1 = shift1 & ~((1LL << (ctrl1.mask_msb + 1)) - 1);
-    bool overf = overf0 || overf1;
+    if (interp->evaluation == INTERP_SW_EVALUATION_LAZY) {
+        if (results & (INTERP_SW_RESULT_LANE0 | INTERP_SW_RESULT_FULL)) results |= INTERP_SW_RESULT_RAW0;
+        if (results & (INTERP_SW_RESULT_LANE1 | INTERP_SW_RESULT_FULL)) results |= INTERP_SW_RESULT_RAW1;
+        if ((results & INTERP_SW_RESULT_LANE0) && (interp->kernel_mode & INTERP_SW_MODE_BLEND)) results |= INTERP_SW_RESULT_RAW1;
 
-    uint32_t sextmask0 = (shift0 & (1 << ctrl0.mask_msb)) ? (-1U << (ctrl0.mask_msb + 1)) : 0;
-    uint32_t sextmask1 = (shift1 & (1 << ctrl1.mask_msb)) ? (-1U << (ctrl1.mask_msb + 1)) : 0;
+        results &= interp->stale;
+        if (!results) return;
+    } else {
+        results = INTERP_SW_RESULT_ALL;
+    }
 
-    uint32_t sresult0 = uresult0 | sextmask0;
-    uint32_t sresult1 = uresult1 | sextmask1;
+#if INTERP_SW_STATS
+    bool ctrl_changed = interp_sw_stats_ctrl_changed(interp);
+    INTERP_SW_STATS_COUNT(interp, ctrl_changes, ctrl_changed);
+    INTERP_SW_STATS_COUNT(interp, updates, 1);
+    INTERP_SW_STATS_COUNT(interp, redundant, interp->stale == 0 && !ctrl_changed);
+    interp->stats_ctrl[0] = interp->ctrl[0] & INTERP_SW_CONFIG_BITS;
+    interp->stats_ctrl[1] = interp->ctrl[1] & INTERP_SW_CONFIG_BITS;
+#endif
 
-    uint32_t result0 = ctrl0.is_signed ? sresult0 : uresult0;
-    uint32_t result1 = ctrl1.is_signed ? sresult1 : uresult1;
+    interp->stale &= ~results;
+    interp->kernel(interp, results);
+}
 
-    uint32_t addresult0 = interp->base[0] + (ctrl0.add_raw ? input0 : result0);
-    uint32_t addresult1 = interp->base[1] + (ctrl1.add_raw ? input1 : result1);
-    uint32_t addresult2 = interp->base[2] + result0 + (do_blend ? 0 : result1);
+static void interp_sw_run_batch(interp_sw_t *interp, uint32_t pop, uint32_t add_lane, const uint32_t *vals, uint32_t *out, size_t n) {
+    if (n == 0) return;
 
-    uint32_t uclamp0 = result0 < interp->base[0] ? interp->base[0] : (result0 > interp->base[1] ? interp->base[1] : result0);
-    uint32_t sclamp0 = (int32_t)result0 < (int32_t)interp->base[0] ? interp->base[0] : ((int32_t)result0 > (int32_t)interp->base[1] ? interp->base[1] : result0);
-    uint32_t clamp0 = ctrl0.is_signed ? sclamp0 : uclamp0;
+    interp_sw_refresh_kernel(interp);
+    interp_sw_batch_kernels[interp->kernel_mode](interp, pop, add_lane, vals, out, n);
 
-    uint8_t alpha1 = result1;
-    uint32_t ublend1 = interp->base[0] + (alpha1 * ((uint64_t)interp->base[1] - (uint64_t)interp->base[0]) >> 8);
-    uint32_t sblend1 = interp->base[0] + (alpha1 * ((int64_t)(int32_t)interp->base[1] - (int64_t)(int32_t)interp->base[0]) >> 8);
-    uint32_t blend1 = ctrl1.is_signed ? sblend1 : ublend1;
+    INTERP_SW_STATS_COUNT(interp, pops[pop == 3 ? 0 : pop], n);
+    INTERP_SW_STATS_COUNT(interp, pops[1], pop == 3 ? n : 0);
+    INTERP_SW_STATS_COUNT(interp, writebacks, n);
 
-    interp->peekraw[0] = result0;
-    interp->peekraw[1] = result1;
-    interp->peek[0] = do_blend ? alpha1 : (do_clamp ? clamp0 : addresult0) | (ctrl0.force_msb << 28);
-    interp->peek[1] = (do_blend ? blend1 : addresult1) | (ctrl1.force_msb << 28);
-    interp->peek[2] = addresult2;
+    interp->stale = INTERP_SW_RESULT_ALL;
+    if (interp->evaluation != INTERP_SW_EVALUATION_LAZY) {
+        interp_sw_update_results(interp, INTERP_SW_RESULT_ALL);
+    }
+}
 
-    ctrl0.overf0 = overf0;
-    ctrl0.overf1 = overf1;
-    ctrl0.overf = overf;
-    interp->ctrl[0] = interp_sw_config_to_reg(&ctrl0);
-    interp->ctrl[1] = interp_sw_config_to_reg(&ctrl1);
+// lane selects the batch kernel mode, where 2 and 3 would pop FULL or write
+// 2 * n results, so anything but lane 0 or 1 is rejected
+void interp_sw_pop_lane_results(interp_sw_t *interp, uint32_t lane, uint32_t *out, size_t n) {
+    assert(lane <= 1);
+    if (lane > 1) return;
+    interp_sw_run_batch(interp, lane, 0, NULL, out, n);
+}
+
+void interp_sw_pop_full_results(interp_sw_t *interp, uint32_t *out, size_t n) {
+    interp_sw_run_batch(interp, 2, 0, NULL, out, n);
+}
+
+void interp_sw_pop_both_lane_results(interp_sw_t *interp, uint32_t *out, size_t n) {
+    interp_sw_run_batch(interp, 3, 0, NULL, out, n);
+}
+
+void interp_sw_add_pop_lane_results(interp_sw_t *interp, uint32_t add_lane, const uint32_t *vals, uint32_t pop_lane, uint32_t *out, size_t n) {
+    assert(add_lane <= 1 && pop_lane <= 1);
+    if (add_lane > 1 || pop_lane > 1) return;
+    interp_sw_run_batch(interp, pop_lane, add_lane, vals, out, n);
 }
 
 void interp_sw_writeback(interp_sw_t *interp) {
+    INTERP_SW_STATS_COUNT(interp, writebacks, 1);
+
     interp_sw_config_t ctrl0, ctrl1;
     interp_sw_config_from_reg(&ctrl0, interp->ctrl[0]);
     interp_sw_config_from_reg(&ctrl1, interp->ctrl[1]);
@@ -92,7 +340,10 @@ void interp_sw_writeback(interp_sw_t *interp) {
     interp->accum[0] = interp->peek[ctrl0.cross_result ? 1 : 0];
     interp->accum[1] = interp->peek[ctrl1.cross_result ? 0 : 1];
 
-    interp_sw_update(interp);
+    interp->stale = INTERP_SW_RESULT_ALL;
+    if (interp->evaluation != INTERP_SW_EVALUATION_LAZY) {
+        interp_sw_update_results(interp, INTERP_SW_RESULT_ALL);
+    }
 }
 
 void interp_sw_set_base_both(interp_sw_t *interp, uint32_t val) {
@@ -100,7 +351,7 @@ void interp_sw_set_base_both(interp_sw_t *interp, uint32_t val) {
     interp_sw_config_from_reg(&ctrl0, interp->ctrl[0]);
     interp_sw_config_from_reg(&ctrl1, interp->ctrl[1]);
 
-    bool do_blend = (ctrl1.blend && interp->index == INTERP_SW_INDEX_BLEND_CAPABLE);
+    bool do_blend = (ctrl0.blend && interp->index == INTERP_SW_INDEX_BLEND_CAPABLE);
 
     uint16_t input0 = val;
     uint16_t input1 = val >> 16;
@@ -114,7 +365,10 @@ void interp_sw_set_base_both(interp_sw_t *interp, uint32_t val) {
     interp->base[0] = base0;
     interp->base[1] = base1;
 
-    interp_sw_update(interp);
+    interp->stale |= INTERP_SW_RESULT_LANE0 | INTERP_SW_RESULT_LANE1 | INTERP_SW_RESULT_FULL;
+    if (interp->evaluation != INTERP_SW_EVALUATION_LAZY) {
+        interp_sw_update_results(interp, INTERP_SW_RESULT_ALL);
+    }
 }
 
 void interp_sw_save(interp_sw_t *interp, interp_sw_save_t *saver) {
@@ -148,5 +402,8 @@ void interp_sw_restore(interp_sw_t *interp, interp_sw_save_t *saver) {
     interp->peekraw[0] = saver->peekraw[0];
     interp->peekraw[1] = saver->peekraw[1];
 
-    interp_sw_update(interp);
+    interp->stale = INTERP_SW_RESULT_ALL;
+    if (interp->evaluation != INTERP_SW_EVALUATION_LAZY) {
+        interp_sw_update_results(interp, INTERP_SW_RESULT_ALL);
+    }
 }
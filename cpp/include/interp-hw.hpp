@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include <hardware/interp.h>
 
 #ifndef YRLF_INTERP_HPP_
@@ -29,6 +30,9 @@ public:
     reg_proxy<io_rw_32[2], INTERP_BASE + SIO_INTERP0_CTRL_LANE0_OFFSET> ctrl;
 
     uint32_t pop(size_t i) { return hw_pop[i]; }
+    void pop_n(size_t i, std::span<uint32_t> out);
+    void pop_full_n(std::span<uint32_t> out) { pop_n(2, out); }
+    void pop_lanes_n(std::span<uint32_t> out);
     uint32_t peek(size_t i) { return hw_peek[i]; }
     uint32_t peekraw(size_t i) { return hw_add[i]; }
     void add(size_t i, uint32_t v) { hw_add[i] = v; }
@@ -53,6 +57,22 @@ using InterpHW1 = InterpHW<1>;
 
 // --- implementation ---
 
+template <size_t N>
+void InterpHW<N>::pop_n(size_t i, std::span<uint32_t> out) {
+    io_ro_32& reg = hw_pop.get()[i];
+    for (uint32_t& v : out) v = reg;
+}
+
+template <size_t N>
+void InterpHW<N>::pop_lanes_n(std::span<uint32_t> out) {
+    io_ro_32& peek0 = hw_peek.get()[0];
+    io_ro_32& pop1 = hw_pop.get()[1];
+    for (size_t k = 0; k + 1 < out.size(); k += 2) {
+        out[k] = peek0;
+        out[k + 1] = pop1;
+    }
+}
+
 template <size_t N>
 void InterpHW<N>::save(InterpState& state) {
     state.ctrl[0] = ctrl[0];
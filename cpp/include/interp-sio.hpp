@@ -0,0 +1,97 @@
+#ifndef YRLF_INTERP_SIO_HPP_
+#define YRLF_INTERP_SIO_HPP_
+
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#ifndef YRLF_INTERP_HPP_
+#include <interp.hpp>
+#endif
+
+// not std::hardware_destructive_interference_size, which may differ between
+// translation units
+constexpr size_t INTERP_CACHE_LINE_SIZE = 64;
+
+// interpolators of both cores, as found in the SIO block of each core
+template <InterpGeneration G = InterpGeneration::DEFAULT, InterpEvaluation E = InterpEvaluation::EAGER>
+struct InterpSIO {
+    constexpr static size_t CORE_COUNT = 2;
+
+    // aligned, so cores simulated on different threads never share a cache line
+    struct alignas(INTERP_CACHE_LINE_SIZE) Core {
+        InterpSW<0, G, E> interp0;
+        InterpSW<1, G, E> interp1;
+
+        template <size_t N>
+        constexpr InterpSW<N, G, E>& interp() {
+            if constexpr (N == 0) {
+                return interp0;
+            } else {
+                return interp1;
+            }
+        }
+    };
+
+    Core core[CORE_COUNT];
+
+    template <typename Fn0, typename Fn1>
+    void run(Fn0&& core0, Fn1&& core1);
+
+    // core simulated by the calling thread inside run() of this InterpSIO,
+    // throws std::logic_error on any other thread
+    Core& this_core() { return core[get_core_num()]; }
+    size_t get_core_num() const;
+
+private:
+    // InterpSIO and core simulated by a thread, set by run()
+    struct Current {
+        const InterpSIO* sio;
+        size_t num;
+    };
+
+    static inline thread_local Current current = { nullptr, 0 };
+};
+
+// --- implementation ---
+
+template <InterpGeneration G, InterpEvaluation E>
+size_t InterpSIO<G, E>::get_core_num() const {
+    if (current.sio != this) throw std::logic_error("InterpSIO: calling thread is not simulating a core of this InterpSIO");
+    return current.num;
+}
+
+// runs core0(core[0]) on the calling thread and core1(core[1]) on a new
+// thread, like multicore_launch_core1(), and returns when both are done.
+// Exceptions are passed on to the caller, those of core 0 first.
+template <InterpGeneration G, InterpEvaluation E>
+template <typename Fn0, typename Fn1>
+void InterpSIO<G, E>::run(Fn0&& core0, Fn1&& core1) {
+    Current prev = current;
+    std::exception_ptr error1;
+
+    std::thread thread([&] {
+        current = { this, 1 };
+        try {
+            core1(core[1]);
+        } catch (...) {
+            error1 = std::current_exception();
+        }
+    });
+
+    current = { this, 0 };
+    try {
+        core0(core[0]);
+    } catch (...) {
+        thread.join();
+        current = prev;
+        throw;
+    }
+    thread.join();
+
+    current = prev;
+    if (error1) std::rethrow_exception(error1);
+}
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef YRLF_INTERP_SW_BATCH_HPP_
+#define YRLF_INTERP_SW_BATCH_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifndef YRLF_INTERP_HPP_
+#include <interp.hpp>
+#endif
+
+enum struct InterpBatchIsa {
+    SCALAR,
+    SSE2,
+    AVX2,
+};
+
+// registers of all instances of an InterpSWBatch, one row per register
+struct InterpBatchRows {
+    uint32_t* accum[2];
+    uint32_t* base[3];
+    uint32_t* ctrl[2];
+    uint32_t* peek[3];
+    uint32_t* peekraw[2];
+};
+
+template <size_t N = 0, InterpGeneration G = InterpGeneration::DEFAULT, size_t Width = 8>
+struct InterpSWBatch {
+private:
+    static_assert(N == 0 || N == 1, "invalid interpolator index");
+    static_assert(Width == 8 || Width == 16, "invalid batch width");
+
+public:
+    explicit InterpSWBatch(size_t count, InterpBatchIsa isa = detect_isa());
+    InterpSWBatch(const InterpSWBatch& other);
+    InterpSWBatch(InterpSWBatch&& other) noexcept;
+    InterpSWBatch& operator=(const InterpSWBatch&) = delete;
+
+    size_t size() const { return count; }
+    InterpBatchIsa get_isa() const { return isa; }
+    void set_isa(InterpBatchIsa isa) { this->isa = isa; }
+    static InterpBatchIsa detect_isa();
+
+    uint32_t* accum(size_t i) { return rows.accum[i]; }
+    uint32_t* base(size_t i) { return rows.base[i]; }
+    uint32_t* ctrl(size_t i) { return rows.ctrl[i]; }
+
+    // the spans hold one value per instance, any other size throws
+    // std::invalid_argument
+    void pop(size_t i, std::span<uint32_t> out);
+    void peek(size_t i, std::span<uint32_t> out);
+    void peekraw(size_t i, std::span<uint32_t> out);
+    void add(size_t i, std::span<const uint32_t> v);
+    void update();
+
+    void save(size_t k, InterpState& state) const;
+    void restore(size_t k, const InterpState& state);
+
+private:
+    void bind_rows();
+    void check_size(size_t size) const;
+    void update_blocks();
+    void writeback();
+
+    size_t count;
+    size_t padded;
+    InterpBatchIsa isa;
+    std::vector<uint32_t> regs;
+    InterpBatchRows rows;
+};
+
+// --- implementation ---
+
+template <size_t Width>
+struct InterpBatchVector;
+
+template <>
+struct InterpBatchVector<8> {
+    typedef uint32_t v32 __attribute__((vector_size(32)));
+    typedef int32_t vs32 __attribute__((vector_size(32)));
+};
+
+template <>
+struct InterpBatchVector<16> {
+    typedef uint32_t v32 __attribute__((vector_size(64)));
+    typedef int32_t vs32 __attribute__((vector_size(64)));
+};
+
+// evaluates the update() datapath of InterpSW for Width instances starting at k
+template <size_t N, InterpGeneration G, size_t Width>
+[[gnu::always_inline]] inline void interp_batch_update_block(const InterpBatchRows& rows, size_t k) {
+    using v32 = typename InterpBatchVector<Width>::v32;
+    using vs32 = typename InterpBatchVector<Width>::vs32;
+
+    v32 accum0, accum1, base0, base1, base2, ctrl0, ctrl1;
+    memcpy(&accum0, rows.accum[0] + k, sizeof (v32));
+    memcpy(&accum1, rows.accum[1] + k, sizeof (v32));
+    memcpy(&base0, rows.base[0] + k, sizeof (v32));
+    memcpy(&base1, rows.base[1] + k, sizeof (v32));
+    memcpy(&base2, rows.base[2] + k, sizeof (v32));
+    memcpy(&ctrl0, rows.ctrl[0] + k, sizeof (v32));
+    memcpy(&ctrl1, rows.ctrl[1] + k, sizeof (v32));
+
+    const v32 zero = {};
+    const v32 ones = ~zero;
+
+    v32 shift_amount0 = ctrl0 & 31;
+    v32 shift_amount1 = ctrl1 & 31;
+    v32 mask_lsb0 = (ctrl0 >> 5) & 31;
+    v32 mask_lsb1 = (ctrl1 >> 5) & 31;
+    v32 mask_msb0 = (ctrl0 >> 10) & 31;
+    v32 mask_msb1 = (ctrl1 >> 10) & 31;
+    vs32 is_signed0 = (ctrl0 & (1 << 15)) != 0;
+    vs32 is_signed1 = (ctrl1 & (1 << 15)) != 0;
+    vs32 cross_input0 = (ctrl0 & (1 << 16)) != 0;
+    vs32 cross_input1 = (ctrl1 & (1 << 16)) != 0;
+    vs32 add_raw0 = (ctrl0 & (1 << 18)) != 0;
+    vs32 add_raw1 = (ctrl1 & (1 << 18)) != 0;
+    v32 force_bits0 = (ctrl0 >> 19 & 3) << 28;
+    v32 force_bits1 = (ctrl1 >> 19 & 3) << 28;
+    vs32 do_blend = N == 0 ? (ctrl0 & (1 << 21)) != 0 : (vs32)zero;
+    vs32 do_clamp = N == 1 ? (ctrl0 & (1 << 22)) != 0 : (vs32)zero;
+
+    v32 input0 = cross_input0 ? accum1 : accum0;
+    v32 input1 = cross_input1 ? accum0 : accum1;
+
+    v32 shift0;
+    v32 shift1;
+    switch (G) {
+        case InterpGeneration::RP2040:
+            shift0 = input0 >> shift_amount0;
+            shift1 = input1 >> shift_amount1;
+            break;
+        case InterpGeneration::RP2350:
+            shift0 = (input0 >> shift_amount0) | (input0 << ((32 - shift_amount0) & 31));
+            shift1 = (input1 >> shift_amount1) | (input1 << ((32 - shift_amount1) & 31));
+            break;
+    }
+
+    v32 top0 = ones >> (31 - mask_msb0);
+    v32 top1 = ones >> (31 - mask_msb1);
+    v32 mask0 = top0 & (ones << mask_lsb0);
+    v32 mask1 = top1 & (ones << mask_lsb1);
+
+    vs32 overf0 = (shift0 & ~top0) != 0;
+    vs32 overf1 = (shift1 & ~top1) != 0;
+
+    vs32 sign0 = ((shift0 >> mask_msb0) & 1) != 0;
+    vs32 sign1 = ((shift1 >> mask_msb1) & 1) != 0;
+    v32 result0 = (shift0 & mask0) | ((sign0 & is_signed0) ? ~top0 : zero);
+    v32 result1 = (shift1 & mask1) | ((sign1 & is_signed1) ? ~top1 : zero);
+
+    v32 addresult0 = base0 + (add_raw0 ? input0 : result0);
+    v32 addresult1 = base1 + (add_raw1 ? input1 : result1);
+    v32 addresult2 = base2 + result0 + (do_blend ? zero : result1);
+
+    v32 peek0 = addresult0 | force_bits0;
+    v32 peek1 = addresult1 | force_bits1;
+
+    if (N == 1) {
+        v32 uclamp0 = result0 < base0 ? base0 : (result0 > base1 ? base1 : result0);
+        vs32 sresult0 = (vs32)result0;
+        vs32 sclamp0 = sresult0 < (vs32)base0 ? (vs32)base0 : (sresult0 > (vs32)base1 ? (vs32)base1 : sresult0);
+        v32 clamp0 = is_signed0 ? (v32)sclamp0 : uclamp0;
+
+        peek0 = do_clamp ? clamp0 | force_bits0 : peek0;
+    }
+
+    if (N == 0) {
+        // (alpha * (base1 - base0)) >> 8 on a 33-bit difference, split into
+        // 16-bit halves so that it stays in 32-bit lanes
+        v32 alpha1 = result1 & 0xff;
+        v32 diff = base1 - base0;
+        vs32 negative = is_signed1 ? (vs32)base1 < (vs32)base0 : base1 < base0;
+        v32 blend1 = base0 + ((alpha1 * (diff & 0xffff)) >> 8) + ((alpha1 * (diff >> 16)) << 8)
+            - (negative ? alpha1 << 24 : zero);
+
+        peek0 = do_blend ? alpha1 : peek0;
+        peek1 = do_blend ? blend1 | force_bits1 : peek1;
+    }
+
+    v32 config_bits0 = zero + (N == 0 ? 0x003fffffU : 0x005fffffU);
+    v32 overf_bits = (overf0 ? (v32)(InterpPlan::OVERF0_BITS + zero) : zero)
+        | (overf1 ? (v32)(InterpPlan::OVERF1_BITS + zero) : zero)
+        | ((overf0 | overf1) ? (v32)(InterpPlan::OVERF_BITS + zero) : zero);
+    ctrl0 = (ctrl0 & config_bits0) | overf_bits;
+    ctrl1 = ctrl1 & 0x001fffff;
+
+    memcpy(rows.ctrl[0] + k, &ctrl0, sizeof (v32));
+    memcpy(rows.ctrl[1] + k, &ctrl1, sizeof (v32));
+    memcpy(rows.peek[0] + k, &peek0, sizeof (v32));
+    memcpy(rows.peek[1] + k, &peek1, sizeof (v32));
+    memcpy(rows.peek[2] + k, &addresult2, sizeof (v32));
+    memcpy(rows.peekraw[0] + k, &result0, sizeof (v32));
+    memcpy(rows.peekraw[1] + k, &result1, sizeof (v32));
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void interp_batch_update_generic(const InterpBatchRows& rows, size_t count) {
+    for (size_t k = 0; k < count; k += Width) {
+        interp_batch_update_block<N, G, Width>(rows, k);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template <size_t N, InterpGeneration G, size_t Width>
+[[gnu::target("sse2")]] void interp_batch_update_sse2(const InterpBatchRows& rows, size_t count) {
+    for (size_t k = 0; k < count; k += Width) {
+        interp_batch_update_block<N, G, Width>(rows, k);
+    }
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+[[gnu::target("avx2")]] void interp_batch_update_avx2(const InterpBatchRows& rows, size_t count) {
+    for (size_t k = 0; k < count; k += Width) {
+        interp_batch_update_block<N, G, Width>(rows, k);
+    }
+}
+#endif
+
+template <size_t N, InterpGeneration G, size_t Width>
+InterpBatchIsa InterpSWBatch<N, G, Width>::detect_isa() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) return InterpBatchIsa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return InterpBatchIsa::SSE2;
+#endif
+    return InterpBatchIsa::SCALAR;
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+InterpSWBatch<N, G, Width>::InterpSWBatch(size_t count, InterpBatchIsa isa) : count(count), isa(isa) {
+    padded = (count + Width - 1) / Width * Width;
+    regs.resize(padded * 12);
+    bind_rows();
+}
+
+// rows point into regs, so copies and moves have to point them at their own
+template <size_t N, InterpGeneration G, size_t Width>
+InterpSWBatch<N, G, Width>::InterpSWBatch(const InterpSWBatch& other)
+    : count(other.count), padded(other.padded), isa(other.isa), regs(other.regs) {
+    bind_rows();
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+InterpSWBatch<N, G, Width>::InterpSWBatch(InterpSWBatch&& other) noexcept
+    : count(other.count), padded(other.padded), isa(other.isa), regs(std::move(other.regs)) {
+    bind_rows();
+    other.count = other.padded = 0;
+    other.regs.clear();
+    other.bind_rows();
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::bind_rows() {
+    uint32_t* row = regs.data();
+    for (uint32_t*& p : rows.accum) { p = row; row += padded; }
+    for (uint32_t*& p : rows.base) { p = row; row += padded; }
+    for (uint32_t*& p : rows.ctrl) { p = row; row += padded; }
+    for (uint32_t*& p : rows.peek) { p = row; row += padded; }
+    for (uint32_t*& p : rows.peekraw) { p = row; row += padded; }
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::check_size(size_t size) const {
+    if (size != count) throw std::invalid_argument("InterpSWBatch: span size does not match the number of instances");
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::update_blocks() {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        case InterpBatchIsa::AVX2: interp_batch_update_avx2<N, G, Width>(rows, padded); break;
+        case InterpBatchIsa::SSE2: interp_batch_update_sse2<N, G, Width>(rows, padded); break;
+#endif
+        default:
+            for (size_t k = 0; k < count; k++) {
+                InterpState state;
+                InterpSW<N, G> intrp;
+                save(k, state);
+                intrp.restore(state);
+                intrp.update();
+                intrp.save(state);
+                restore(k, state);
+            }
+            break;
+    }
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::writeback() {
+    for (size_t k = 0; k < padded; k++) {
+        uint32_t accum0 = rows.peek[(rows.ctrl[0][k] >> 17) & 1][k];
+        uint32_t accum1 = rows.peek[!((rows.ctrl[1][k] >> 17) & 1)][k];
+        rows.accum[0][k] = accum0;
+        rows.accum[1][k] = accum1;
+    }
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::pop(size_t i, std::span<uint32_t> out) {
+    check_size(out.size());
+    update_blocks();
+    std::copy_n(rows.peek[i], count, out.data());
+    writeback();
+    update_blocks();
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::peek(size_t i, std::span<uint32_t> out) {
+    check_size(out.size());
+    update_blocks();
+    std::copy_n(rows.peek[i], count, out.data());
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::peekraw(size_t i, std::span<uint32_t> out) {
+    check_size(out.size());
+    update_blocks();
+    std::copy_n(rows.peekraw[i], count, out.data());
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::add(size_t i, std::span<const uint32_t> v) {
+    check_size(v.size());
+    for (size_t k = 0; k < count; k++) {
+        rows.accum[i][k] += v[k];
+    }
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::update() {
+    update_blocks();
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::save(size_t k, InterpState& state) const {
+    state.ctrl[0] = rows.ctrl[0][k];
+    state.ctrl[1] = rows.ctrl[1][k];
+    state.accum[0] = rows.accum[0][k];
+    state.accum[1] = rows.accum[1][k];
+    state.base[0] = rows.base[0][k];
+    state.base[1] = rows.base[1][k];
+    state.base[2] = rows.base[2][k];
+    state.peek[0] = rows.peek[0][k];
+    state.peek[1] = rows.peek[1][k];
+    state.peek[2] = rows.peek[2][k];
+    state.peekraw[0] = rows.peekraw[0][k];
+    state.peekraw[1] = rows.peekraw[1][k];
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+void InterpSWBatch<N, G, Width>::restore(size_t k, const InterpState& state) {
+    rows.ctrl[0][k] = state.ctrl[0];
+    rows.ctrl[1][k] = state.ctrl[1];
+    rows.accum[0][k] = state.accum[0];
+    rows.accum[1][k] = state.accum[1];
+    rows.base[0][k] = state.base[0];
+    rows.base[1][k] = state.base[1];
+    rows.base[2][k] = state.base[2];
+    rows.peek[0][k] = state.peek[0];
+    rows.peek[1][k] = state.peek[1];
+    rows.peek[2][k] = state.peek[2];
+    rows.peekraw[0][k] = state.peekraw[0];
+    rows.peekraw[1][k] = state.peekraw[1];
+}
+
+#endif
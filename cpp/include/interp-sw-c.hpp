@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include "interp.h"
 #include "interp_ctrl.h"
 
@@ -11,7 +12,7 @@
 #endif
 
 template <size_t N = 0, InterpGeneration G = InterpGeneration::DEFAULT>
-struct InterpSWC {
+struct InterpSWC : private interp_sw_t {
 private:
     static_assert(N == 0 || N == 1, "invalid interpolator index");
 
@@ -20,11 +21,15 @@ public:
     InterpSWC(const InterpSWC&) = default;
     InterpSWC(InterpSWC&&) = default;
 
-    uint32_t accum[2];
-    uint32_t base[3];
-    uint32_t ctrl[2];
+    // registers are shared with the underlying interp_sw_t
+    using interp_sw_t::accum;
+    using interp_sw_t::base;
+    using interp_sw_t::ctrl;
 
     uint32_t pop(size_t i);
+    void pop_n(size_t i, std::span<uint32_t> out);
+    void pop_full_n(std::span<uint32_t> out) { pop_n(2, out); }
+    void pop_lanes_n(std::span<uint32_t> out);
     uint32_t peek(size_t i);
     uint32_t peekraw(size_t i);
     void add(size_t i, uint32_t v);
@@ -37,8 +42,11 @@ public:
     void save(InterpState& state);
     void restore(const InterpState& state);
 
+    InterpStats stats() const;
+    void reset_stats() { interp_sw_reset_stats(interp()); }
+
 private:
-    interp_sw_t interp;
+    interp_sw_t* interp() { return this; }
 };
 
 using InterpSWC0 = InterpSWC<0>;
@@ -47,47 +55,62 @@ using InterpSWC1 = InterpSWC<1>;
 // --- implementation ---
 
 template <size_t N, InterpGeneration G>
-InterpSWC<N, G>::InterpSWC() {
-    interp.index = N;
-    interp.generation = G == InterpGeneration::RP2040 ? INTERP_SW_GENERATION_RP2040 : INTERP_SW_GENERATION_RP2350;
+InterpSWC<N, G>::InterpSWC() : interp_sw_t() {
+    index = N;
+    generation = G == InterpGeneration::RP2040 ? INTERP_SW_GENERATION_RP2040 : INTERP_SW_GENERATION_RP2350;
+    evaluation = INTERP_SW_EVALUATION_EAGER;
 }
 
 template <size_t N, InterpGeneration G>
 uint32_t InterpSWC<N, G>::pop(size_t i) {
     if (i != 2) {
-        return interp_sw_pop_lane_result(&interp, i);
+        return interp_sw_pop_lane_result(interp(), i);
+    } else {
+        return interp_sw_pop_full_result(interp());
+    }
+}
+
+template <size_t N, InterpGeneration G>
+void InterpSWC<N, G>::pop_n(size_t i, std::span<uint32_t> out) {
+    if (i != 2) {
+        interp_sw_pop_lane_results(interp(), i, out.data(), out.size());
     } else {
-        return interp_sw_pop_full_result(&interp);
+        interp_sw_pop_full_results(interp(), out.data(), out.size());
     }
 }
 
+template <size_t N, InterpGeneration G>
+void InterpSWC<N, G>::pop_lanes_n(std::span<uint32_t> out) {
+    interp_sw_pop_both_lane_results(interp(), out.data(), out.size() / 2);
+}
+
 template <size_t N, InterpGeneration G>
 uint32_t InterpSWC<N, G>::peek(size_t i) {
     if (i != 2) {
-        return interp_sw_peek_lane_result(&interp, i);
+        return interp_sw_peek_lane_result(interp(), i);
     } else {
-        return interp_sw_peek_full_result(&interp);
+        return interp_sw_peek_full_result(interp());
     }
 }
 
 template <size_t N, InterpGeneration G>
 uint32_t InterpSWC<N, G>::peekraw(size_t i) {
-    return interp_sw_get_raw(&interp, i);
+    return interp_sw_get_raw(interp(), i);
 }
 
 template <size_t N, InterpGeneration G>
 void InterpSWC<N, G>::add(size_t i, uint32_t v) {
-    interp_sw_add_accumulator(&interp, i, v);
+    interp_sw_add_accumulator(interp(), i, v);
 }
 
 template <size_t N, InterpGeneration G>
 void InterpSWC<N, G>::base01(uint32_t v) {
-    interp_sw_set_base_both(&interp, v);
+    interp_sw_set_base_both(interp(), v);
 }
 
 template <size_t N, InterpGeneration G>
 void InterpSWC<N, G>::update() {
-    interp_sw_update(&interp);
+    interp_sw_update(interp());
 }
 
 template <size_t N, InterpGeneration G>
@@ -106,6 +129,23 @@ void InterpSWC<N, G>::save(InterpState& state) {
     state.peekraw[1] = peekraw(1);
 }
 
+template <size_t N, InterpGeneration G>
+InterpStats InterpSWC<N, G>::stats() const {
+    interp_sw_stats_t c;
+    interp_sw_get_stats(this, &c);
+
+    InterpStats stats;
+    stats.updates = c.updates;
+    stats.redundant = c.redundant;
+    stats.pops[0] = c.pops[0];
+    stats.pops[1] = c.pops[1];
+    stats.pops[2] = c.pops[2];
+    stats.writebacks = c.writebacks;
+    stats.ctrl_changes = c.ctrl_changes;
+    stats.overf_changes = c.overf_changes;
+    return stats;
+}
+
 template <size_t N, InterpGeneration G>
 void InterpSWC<N, G>::restore(const InterpState& state) {
     ctrl[0] = state.ctrl[0];
@@ -0,0 +1,271 @@
+#ifndef YRLF_INTERP_SW_FIXED_HPP_
+#define YRLF_INTERP_SW_FIXED_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#ifndef YRLF_INTERP_HPP_
+#include <interp.hpp>
+#endif
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1 = InterpCtrl{}>
+struct InterpSWFixed {
+private:
+    static_assert(N == 0 || N == 1, "invalid interpolator index");
+    static_assert(!(N == 0 && Ctrl0.clamp), "clamp is only available on interpolator 1");
+    static_assert(!(N == 1 && Ctrl0.blend), "blend is only available on interpolator 0");
+    static_assert(!Ctrl1.clamp && !Ctrl1.blend, "clamp and blend are only available on lane 0");
+
+    constexpr static InterpPlan plan = InterpPlan::build<N>(Ctrl0.to(), Ctrl1.to());
+
+public:
+    constexpr InterpSWFixed() { update(); }
+
+    constexpr uint32_t pop(size_t i) { uint32_t v = result[i]; writeback(); return v; }
+    constexpr void pop_n(size_t i, std::span<uint32_t> out);
+    constexpr void pop_full_n(std::span<uint32_t> out) { pop_n(2, out); }
+    constexpr void pop_lanes_n(std::span<uint32_t> out);
+    constexpr uint32_t peek(size_t i) { return result[i]; }
+    constexpr uint32_t peekraw(size_t i) { return smresult[i]; }
+    constexpr void add(size_t i, uint32_t v) { accum[i] += v; update(); }
+    constexpr void base01(uint32_t v) { writebase01(v); }
+    constexpr uint32_t read_base01() { return 0; }
+    constexpr uint32_t read_ctrl(size_t i) const { return ctrl[i]; }
+    constexpr uint32_t read_accum(size_t i) const { return accum[i]; }
+    constexpr uint32_t read_base(size_t i) const { return base[i]; }
+    constexpr void write_accum(size_t i, uint32_t v) { accum[i] = v; update(); }
+    constexpr void write_base(size_t i, uint32_t v) { base[i] = v; update(); }
+    constexpr void update();
+
+    constexpr InterpSWFixed& operator=(const InterpState& state) { restore(state); update(); return *this; }
+    constexpr operator InterpState() const { InterpState state; save(state); return state; }
+    constexpr void save(InterpState& state) const;
+    constexpr void restore(const InterpState& state);
+
+private:
+    template <size_t L>
+    constexpr static uint32_t lane_raw(uint32_t input, bool& overf);
+    constexpr static uint32_t lane0_result(const uint32_t (&base)[3], uint32_t input0, uint32_t raw0, uint32_t raw1);
+    constexpr static uint32_t lane1_result(const uint32_t (&base)[3], uint32_t input1, uint32_t raw1);
+    constexpr static uint32_t full_result(const uint32_t (&base)[3], uint32_t raw0, uint32_t raw1);
+
+    template <size_t L>
+    constexpr void pop_loop(std::span<uint32_t> out);
+
+    constexpr void writeback();
+    constexpr void writebase01(uint32_t v);
+
+    // results are cached, so accum and base are only written through
+    // functions that update them
+    uint32_t accum[2] = {};
+    uint32_t base[3] = {};
+    // the constant CTRL with the OVERF flags of the last update
+    uint32_t ctrl[2] = { plan.ctrl[0], plan.ctrl[1] };
+    uint32_t smresult[2] = {};
+    uint32_t result[3] = {};
+};
+
+// --- implementation ---
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+template <size_t L>
+constexpr uint32_t InterpSWFixed<N, G, Ctrl0, Ctrl1>::lane_raw(uint32_t input, bool& overf) {
+    constexpr InterpLanePlan lane = plan.lane[L];
+
+    uint32_t shift;
+    switch (G) {
+        case InterpGeneration::RP2040: shift = input >> lane.shift; break;
+        case InterpGeneration::RP2350: shift = std::rotr(input, lane.shift); break;
+    }
+
+    overf = shift & lane.overf_mask;
+    if constexpr (lane.is_signed) {
+        return (shift & lane.mask) | ((shift & lane.sign_bit) ? lane.sext_mask : 0);
+    } else {
+        return shift & lane.mask;
+    }
+}
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+constexpr uint32_t InterpSWFixed<N, G, Ctrl0, Ctrl1>::lane0_result(const uint32_t (&base)[3], uint32_t input0, uint32_t raw0, uint32_t raw1) {
+    constexpr InterpLanePlan lane0 = plan.lane[0];
+
+    if constexpr (plan.do_blend) {
+        uint8_t alpha1 = raw1;
+        return alpha1;
+    } else if constexpr (plan.do_clamp) {
+        auto s32 = sext<int32_t>;
+        if constexpr (lane0.is_signed) {
+            uint32_t sclamp0 = s32(raw0) < s32(base[0]) ? base[0] : (s32(raw0) > s32(base[1]) ? base[1] : raw0);
+            return sclamp0 | lane0.force_bits;
+        } else {
+            uint32_t uclamp0 = raw0 < base[0] ? base[0] : (raw0 > base[1] ? base[1] : raw0);
+            return uclamp0 | lane0.force_bits;
+        }
+    } else if constexpr (lane0.add_raw) {
+        return (base[0] + input0) | lane0.force_bits;
+    } else {
+        return (base[0] + raw0) | lane0.force_bits;
+    }
+}
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+constexpr uint32_t InterpSWFixed<N, G, Ctrl0, Ctrl1>::lane1_result(const uint32_t (&base)[3], uint32_t input1, uint32_t raw1) {
+    constexpr InterpLanePlan lane1 = plan.lane[1];
+
+    if constexpr (plan.do_blend) {
+        auto u64 = zext<uint64_t>;
+        auto s64 = sext<int64_t>;
+        uint8_t alpha1 = raw1;
+        if constexpr (lane1.is_signed) {
+            uint32_t sblend1 = base[0] + (alpha1 * (s64(base[1]) - s64(base[0])) >> 8);
+            return sblend1 | lane1.force_bits;
+        } else {
+            uint32_t ublend1 = base[0] + (alpha1 * (u64(base[1]) - u64(base[0])) >> 8);
+            return ublend1 | lane1.force_bits;
+        }
+    } else if constexpr (lane1.add_raw) {
+        return (base[1] + input1) | lane1.force_bits;
+    } else {
+        return (base[1] + raw1) | lane1.force_bits;
+    }
+}
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+constexpr uint32_t InterpSWFixed<N, G, Ctrl0, Ctrl1>::full_result(const uint32_t (&base)[3], uint32_t raw0, uint32_t raw1) {
+    if constexpr (plan.do_blend) {
+        return base[2] + raw0;
+    } else {
+        return base[2] + raw0 + raw1;
+    }
+}
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+constexpr void InterpSWFixed<N, G, Ctrl0, Ctrl1>::pop_n(size_t i, std::span<uint32_t> out) {
+    switch (i) {
+        case 0: pop_loop<0>(out); break;
+        case 1: pop_loop<1>(out); break;
+        case 2: pop_loop<2>(out); break;
+    }
+}
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+constexpr void InterpSWFixed<N, G, Ctrl0, Ctrl1>::pop_lanes_n(std::span<uint32_t> out) {
+    pop_loop<3>(out.first(out.size() & ~size_t(1)));
+}
+
+// pops lane L into out, or lane 0 and lane 1 interleaved if L == 3
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+template <size_t L>
+constexpr void InterpSWFixed<N, G, Ctrl0, Ctrl1>::pop_loop(std::span<uint32_t> out) {
+    if (out.empty()) return;
+
+    // local copies, so stores to out cannot alias the interpolator state
+    const uint32_t b[3] = { base[0], base[1], base[2] };
+    uint32_t a[2] = { accum[0], accum[1] };
+
+    constexpr size_t step = L == 3 ? 2 : 1;
+    for (size_t k = 0; k < out.size(); k += step) {
+        uint32_t input0 = a[plan.lane[0].input];
+        uint32_t input1 = a[plan.lane[1].input];
+        bool overf0, overf1;
+        uint32_t raw0 = lane_raw<0>(input0, overf0);
+        uint32_t raw1 = lane_raw<1>(input1, overf1);
+        uint32_t r[2] = {
+            lane0_result(b, input0, raw0, raw1),
+            lane1_result(b, input1, raw1),
+        };
+
+        if constexpr (L == 3) {
+            out[k] = r[0];
+            out[k + 1] = r[1];
+        } else if constexpr (L == 2) {
+            out[k] = full_result(b, raw0, raw1);
+        } else {
+            out[k] = r[L];
+        }
+
+        a[0] = r[plan.lane[0].writeback];
+        a[1] = r[plan.lane[1].writeback];
+    }
+
+    accum[0] = a[0];
+    accum[1] = a[1];
+    update();
+}
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+constexpr void InterpSWFixed<N, G, Ctrl0, Ctrl1>::update() {
+    uint32_t input0 = accum[plan.lane[0].input];
+    uint32_t input1 = accum[plan.lane[1].input];
+
+    bool overf0, overf1;
+    smresult[0] = lane_raw<0>(input0, overf0);
+    smresult[1] = lane_raw<1>(input1, overf1);
+
+    uint32_t overf = (overf0 ? InterpPlan::OVERF0_BITS : 0) | (overf1 ? InterpPlan::OVERF1_BITS : 0);
+    ctrl[0] = plan.ctrl[0] | overf | (overf ? InterpPlan::OVERF_BITS : 0);
+    ctrl[1] = plan.ctrl[1];
+
+    result[0] = lane0_result(base, input0, smresult[0], smresult[1]);
+    result[1] = lane1_result(base, input1, smresult[1]);
+    result[2] = full_result(base, smresult[0], smresult[1]);
+}
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+constexpr void InterpSWFixed<N, G, Ctrl0, Ctrl1>::writeback() {
+    accum[0] = result[plan.lane[0].writeback];
+    accum[1] = result[plan.lane[1].writeback];
+    update();
+}
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+constexpr void InterpSWFixed<N, G, Ctrl0, Ctrl1>::writebase01(uint32_t v) {
+    constexpr bool signed0 = plan.do_blend ? plan.lane[1].is_signed : plan.lane[0].is_signed;
+    constexpr bool signed1 = plan.lane[1].is_signed;
+
+    uint16_t input0 = v;
+    uint16_t input1 = v >> 16;
+
+    base[0] = signed0 ? sext<uint32_t>(sext<int16_t>(input0)) : input0;
+    base[1] = signed1 ? sext<uint32_t>(sext<int16_t>(input1)) : input1;
+    update();
+}
+
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+constexpr void InterpSWFixed<N, G, Ctrl0, Ctrl1>::save(InterpState& state) const {
+    state.ctrl[0] = ctrl[0];
+    state.ctrl[1] = ctrl[1];
+    state.accum[0] = accum[0];
+    state.accum[1] = accum[1];
+    state.base[0] = base[0];
+    state.base[1] = base[1];
+    state.base[2] = base[2];
+    state.peek[0] = result[0];
+    state.peek[1] = result[1];
+    state.peek[2] = result[2];
+    state.peekraw[0] = smresult[0];
+    state.peekraw[1] = smresult[1];
+}
+
+// CTRL is part of the type, so only the OVERF flags of state.ctrl are kept
+// until the next update
+template <size_t N, InterpGeneration G, InterpCtrl Ctrl0, InterpCtrl Ctrl1>
+constexpr void InterpSWFixed<N, G, Ctrl0, Ctrl1>::restore(const InterpState& state) {
+    ctrl[0] = plan.ctrl[0] | (state.ctrl[0] & (InterpPlan::OVERF0_BITS | InterpPlan::OVERF1_BITS | InterpPlan::OVERF_BITS));
+    ctrl[1] = plan.ctrl[1];
+    accum[0] = state.accum[0];
+    accum[1] = state.accum[1];
+    base[0] = state.base[0];
+    base[1] = state.base[1];
+    base[2] = state.base[2];
+    result[0] = state.peek[0];
+    result[1] = state.peek[1];
+    result[2] = state.peek[2];
+    smresult[0] = state.peekraw[0];
+    smresult[1] = state.peekraw[1];
+}
+
+#endif
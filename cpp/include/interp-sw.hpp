@@ -1,42 +1,179 @@
 #ifndef YRLF_INTERP_SW_HPP_
 #define YRLF_INTERP_SW_HPP_
 
+#include <array>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <span>
+#include <utility>
 
 #ifndef YRLF_INTERP_HPP_
 #include <interp.hpp>
 #endif
 
-template <size_t N = 0, InterpGeneration G = InterpGeneration::DEFAULT>
+// decoded settings of one interpolator lane
+struct InterpLanePlan {
+    uint32_t mask;
+    uint32_t overf_mask;
+    uint32_t sign_bit;
+    uint32_t sext_mask;
+    uint32_t force_bits;
+    uint8_t shift;
+    uint8_t input;
+    uint8_t writeback;
+    bool is_signed;
+    bool add_raw;
+};
+
+// decoded settings of both CTRL registers, rebuilt only when CTRL changes
+struct InterpPlan {
+    constexpr static uint32_t CONFIG_BITS = 0x007fffff;
+    constexpr static uint32_t OVERF0_BITS = 0x00800000;
+    constexpr static uint32_t OVERF1_BITS = 0x01000000;
+    constexpr static uint32_t OVERF_BITS = 0x02000000;
+
+    // mode bits selecting a specialized kernel
+    constexpr static uint8_t MODE_SPECIAL = 0x01; // blend on interpolator 0, clamp on interpolator 1
+    constexpr static uint8_t MODE_SIGNED0 = 0x02;
+    constexpr static uint8_t MODE_SIGNED1 = 0x04;
+    constexpr static uint8_t MODE_ADD_RAW0 = 0x08;
+    constexpr static uint8_t MODE_ADD_RAW1 = 0x10;
+    constexpr static size_t MODE_COUNT = 32;
+
+    // sanitized CTRL registers without OVERF flags, ~0 if not yet built
+    uint32_t ctrl[2] = { ~0U, ~0U };
+    InterpLanePlan lane[2] = {};
+    bool do_clamp = false;
+    bool do_blend = false;
+    uint8_t mode = 0;
+
+    template <size_t N>
+    constexpr static InterpPlan build(uint32_t ctrl0, uint32_t ctrl1);
+};
+
+// collects InterpStats if RP2040_INTERP_WITH_STATS is set, otherwise empty and
+// every count() compiles to nothing
+struct InterpStatsCounter {
+#if RP2040_INTERP_WITH_STATS
+    constexpr static bool enabled = true;
+
+    template <typename Fn>
+    constexpr void count(Fn fn) { fn(stats); }
+    constexpr InterpStats snapshot() const { return stats; }
+    constexpr void reset() { stats = {}; }
+
+private:
+    InterpStats stats;
+#else
+    constexpr static bool enabled = false;
+
+    template <typename Fn>
+    constexpr void count(Fn) {}
+    constexpr InterpStats snapshot() const { return {}; }
+    constexpr void reset() {}
+#endif
+};
+
+template <size_t N = 0, InterpGeneration G = InterpGeneration::DEFAULT, InterpEvaluation E = InterpEvaluation::EAGER>
 struct InterpSW {
 private:
     static_assert(N == 0 || N == 1, "invalid interpolator index");
 
 public:
-    uint32_t accum[2];
-    uint32_t base[3];
-    uint32_t ctrl[2];
-
-    uint32_t pop(size_t i) { update(); uint32_t v = result[i]; writeback(); return v; }
-    uint32_t peek(size_t i) { update(); return result[i]; }
-    uint32_t peekraw(size_t i) { update(); return smresult[i]; }
-    void add(size_t i, uint32_t v) { accum[i] += v; }
-    void base01(uint32_t v) { writebase01(v); }
-    uint32_t read_base01() { return 0; }
-    void update();
-
-    InterpSW& operator=(const InterpState& state) { restore(state); update(); return *this; }
-    operator InterpState() const { InterpState state; save(state); return state; }
-    void save(InterpState& state) const;
-    void restore(const InterpState& state);
+    uint32_t accum[2] = {};
+    uint32_t base[3] = {};
+    uint32_t ctrl[2] = {};
+
+    constexpr uint32_t pop(size_t i);
+    constexpr void pop_n(size_t i, std::span<uint32_t> out);
+    constexpr void pop_full_n(std::span<uint32_t> out) { pop_n(2, out); }
+    constexpr void pop_lanes_n(std::span<uint32_t> out);
+    constexpr void advance(uint64_t k);
+    constexpr uint32_t peek(size_t i) { refresh_plan(); compute(result_bit(i)); return result[i]; }
+    constexpr uint32_t peekraw(size_t i) { refresh_plan(); compute(RESULT_RAW0 << i); return smresult[i]; }
+    constexpr void add(size_t i, uint32_t v) { accum[i] += v; refresh_plan(); stale = RESULT_ALL; compute(E == InterpEvaluation::EAGER ? RESULT_ALL : 0); }
+    constexpr void base01(uint32_t v) { writebase01(v); }
+    constexpr uint32_t read_base01() { return 0; }
+    constexpr void update();
+
+    constexpr InterpSW& operator=(const InterpState& state) { restore(state); if (E == InterpEvaluation::EAGER) update(); return *this; }
+    constexpr operator InterpState() const { InterpState state; save(state); return state; }
+    constexpr void save(InterpState& state) const;
+    constexpr void restore(const InterpState& state);
+
+    constexpr InterpStats stats() const { return counter.snapshot(); }
+    constexpr void reset_stats() { counter.reset(); }
 
 private:
-    void writeback();
-    void writebase01(uint32_t v);
+    // cached results, same layout as INTERP_SW_RESULT_* in the C library
+    constexpr static uint8_t RESULT_LANE0 = 0x01;
+    constexpr static uint8_t RESULT_LANE1 = 0x02;
+    constexpr static uint8_t RESULT_FULL = 0x04;
+    constexpr static uint8_t RESULT_RAW0 = 0x08;
+    constexpr static uint8_t RESULT_RAW1 = 0x10;
+    constexpr static uint8_t RESULT_ALL = 0x1f;
+
+    constexpr static uint8_t result_bit(size_t i) { return RESULT_LANE0 << i; }
+
+    // the datapath is instantiated once per InterpPlan mode M, so that mode
+    // branches are resolved at compile time
+    template <bool Signed>
+    constexpr static uint32_t lane_raw(const InterpLanePlan& lane, uint32_t input, bool& overf);
+    template <uint8_t M>
+    constexpr static uint32_t lane0_result(const InterpPlan& plan, const uint32_t (&base)[3], uint32_t input0, uint32_t raw0, uint32_t raw1);
+    template <uint8_t M>
+    constexpr static uint32_t lane1_result(const InterpPlan& plan, const uint32_t (&base)[3], uint32_t input1, uint32_t raw1);
+    template <uint8_t M>
+    constexpr static uint32_t full_result(const InterpPlan& plan, const uint32_t (&base)[3], uint32_t raw0, uint32_t raw1);
+
+    constexpr static bool lane_is_affine(const InterpPlan& plan, size_t i);
+
+    template <uint8_t M>
+    constexpr void compute_kernel(uint8_t results);
+    template <size_t L, uint8_t M>
+    constexpr void pop_loop(std::span<uint32_t> out);
+    template <uint8_t M>
+    constexpr void advance_loop(uint64_t k);
+
+    struct Kernel {
+        void (*compute)(InterpSW& interp, uint8_t results);
+        void (*pop_loop[4])(InterpSW& interp, std::span<uint32_t> out);
+        void (*advance_loop)(InterpSW& interp, uint64_t k);
+    };
+
+    template <uint8_t M>
+    constexpr static Kernel make_kernel() {
+        return {
+            [](InterpSW& interp, uint8_t results) { interp.compute_kernel<M>(results); },
+            {
+                [](InterpSW& interp, std::span<uint32_t> out) { interp.pop_loop<0, M>(out); },
+                [](InterpSW& interp, std::span<uint32_t> out) { interp.pop_loop<1, M>(out); },
+                [](InterpSW& interp, std::span<uint32_t> out) { interp.pop_loop<2, M>(out); },
+                [](InterpSW& interp, std::span<uint32_t> out) { interp.pop_loop<3, M>(out); },
+            },
+            [](InterpSW& interp, uint64_t k) { interp.advance_loop<M>(k); },
+        };
+    }
+
+    template <size_t... M>
+    constexpr static std::array<Kernel, sizeof...(M)> make_kernels(std::index_sequence<M...>) {
+        return { make_kernel<M>()... };
+    }
+
+    constexpr static std::array<Kernel, InterpPlan::MODE_COUNT> kernels = make_kernels(std::make_index_sequence<InterpPlan::MODE_COUNT>());
 
-    uint32_t smresult[2];
-    uint32_t result[3];
+    constexpr void refresh_plan();
+    constexpr void compute(uint8_t results);
+    constexpr void writeback();
+    constexpr void writebase01(uint32_t v);
+
+    uint32_t smresult[2] = {};
+    uint32_t result[3] = {};
+    InterpPlan plan;
+    const Kernel* kernel = &kernels[0];
+    uint8_t stale = RESULT_ALL;
+    [[no_unique_address]] InterpStatsCounter counter;
 };
 
 using InterpSW0 = InterpSW<0>;
@@ -66,16 +203,19 @@ constexpr zext_t<T> zext{};
 template <typename T>
 constexpr sext_t<T> sext{};
 
-template <size_t N, InterpGeneration G>
-void InterpSW<N, G>::update() {
-    InterpCtrl ctrl0 = InterpCtrl::from(ctrl[0]);
-    InterpCtrl ctrl1 = InterpCtrl::from(ctrl[1]);
+template <size_t N>
+constexpr InterpPlan InterpPlan::build(uint32_t ctrl0_reg, uint32_t ctrl1_reg) {
+    InterpCtrl ctrl0 = InterpCtrl::from(ctrl0_reg);
+    InterpCtrl ctrl1 = InterpCtrl::from(ctrl1_reg);
 
     bool do_clamp = (ctrl0.clamp && N == 1);
     bool do_blend = (ctrl0.blend && N == 0);
 
     ctrl0.clamp = do_clamp;
     ctrl0.blend = do_blend;
+    ctrl0.overf0 = 0;
+    ctrl0.overf1 = 0;
+    ctrl0.overf = 0;
     ctrl0._reserved0 = 0;
     ctrl1.clamp = 0;
     ctrl1.blend = 0;
@@ -84,87 +224,356 @@ void InterpSW<N, G>::update() {
     ctrl1.overf = 0;
     ctrl1._reserved0 = 0;
 
-    uint32_t input0 = accum[ctrl0.cross_input ? 1 : 0];
-    uint32_t input1 = accum[ctrl1.cross_input ? 0 : 1];
+    auto build_lane = [](InterpCtrl c, bool cross_input, bool cross_result) {
+        uint32_t top = (1LL << (c.mask_msb + 1)) - 1;
+
+        InterpLanePlan lane;
+        lane.mask = top & ~((1LL << c.mask_lsb) - 1);
+        lane.overf_mask = ~top;
+        lane.sign_bit = 1U << c.mask_msb;
+        lane.sext_mask = c.is_signed ? ~top : 0;
+        lane.force_bits = c.force_msb << 28;
+        lane.shift = c.shift;
+        lane.input = cross_input;
+        lane.writeback = cross_result;
+        lane.is_signed = c.is_signed;
+        lane.add_raw = c.add_raw;
+        return lane;
+    };
+
+    InterpPlan plan;
+    plan.ctrl[0] = ctrl0.to();
+    plan.ctrl[1] = ctrl1.to();
+    plan.lane[0] = build_lane(ctrl0, ctrl0.cross_input, ctrl0.cross_result);
+    plan.lane[1] = build_lane(ctrl1, !ctrl1.cross_input, !ctrl1.cross_result);
+    plan.do_clamp = do_clamp;
+    plan.do_blend = do_blend;
+    plan.mode = ((do_clamp || do_blend) ? MODE_SPECIAL : 0)
+        | (ctrl0.is_signed ? MODE_SIGNED0 : 0)
+        | (ctrl1.is_signed ? MODE_SIGNED1 : 0)
+        | (ctrl0.add_raw ? MODE_ADD_RAW0 : 0)
+        | (ctrl1.add_raw ? MODE_ADD_RAW1 : 0);
+    return plan;
+}
 
-    uint32_t mask0 = ((1LL << (ctrl0.mask_msb + 1)) - 1) & ~((1LL << ctrl0.mask_lsb) - 1);
-    uint32_t mask1 = ((1LL << (ctrl1.mask_msb + 1)) - 1) & ~((1LL << ctrl1.mask_lsb) - 1);
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr uint32_t InterpSW<N, G, E>::pop(size_t i) {
+    refresh_plan();
+    compute(RESULT_LANE0 | RESULT_LANE1 | result_bit(i));
+    counter.count([&](InterpStats& s) { s.pops[i]++; });
+    uint32_t v = result[i];
+    writeback();
+    return v;
+}
 
-    uint32_t shift0;
-    uint32_t shift1;
-    switch (G) {
-        case InterpGeneration::RP2040:
-            shift0 = input0 >> ctrl0.shift;
-            shift1 = input1 >> ctrl1.shift;
-            break;
-        case InterpGeneration::RP2350:
-            shift0 = (input0 >> ctrl0.shift) | ((uint64_t)input0 << (32 - ctrl0.shift));
-            shift1 = (input1 >> ctrl1.shift) | ((uint64_t)input1 << (32 - ctrl1.shift));
-            break;
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr void InterpSW<N, G, E>::pop_n(size_t i, std::span<uint32_t> out) {
+    if (i > 2 || out.empty()) return;
+
+    counter.count([&](InterpStats& s) { s.pops[i] += out.size(); s.writebacks += out.size(); });
+    refresh_plan();
+    kernel->pop_loop[i](*this, out);
+}
+
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr void InterpSW<N, G, E>::pop_lanes_n(std::span<uint32_t> out) {
+    if (out.size() < 2) return;
+
+    counter.count([&](InterpStats& s) { s.pops[0] += out.size() / 2; s.pops[1] += out.size() / 2; s.writebacks += out.size() / 2; });
+    refresh_plan();
+    kernel->pop_loop[3](*this, out.first(out.size() & ~size_t(1)));
+}
+
+// pops lane L into out, or lane 0 and lane 1 interleaved if L == 3
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+template <size_t L, uint8_t M>
+constexpr void InterpSW<N, G, E>::pop_loop(std::span<uint32_t> out) {
+    // local copies, so stores to out cannot alias the interpolator state
+    const InterpPlan p = plan;
+    const uint32_t b[3] = { base[0], base[1], base[2] };
+    uint32_t a[2] = { accum[0], accum[1] };
+
+    constexpr size_t step = L == 3 ? 2 : 1;
+    for (size_t k = 0; k < out.size(); k += step) {
+        uint32_t input0 = a[p.lane[0].input];
+        uint32_t input1 = a[p.lane[1].input];
+        bool overf0, overf1;
+        uint32_t raw0 = lane_raw<(M & InterpPlan::MODE_SIGNED0) != 0>(p.lane[0], input0, overf0);
+        uint32_t raw1 = lane_raw<(M & InterpPlan::MODE_SIGNED1) != 0>(p.lane[1], input1, overf1);
+        uint32_t r[2] = {
+            lane0_result<M>(p, b, input0, raw0, raw1),
+            lane1_result<M>(p, b, input1, raw1),
+        };
+
+        if constexpr (L == 3) {
+            out[k] = r[0];
+            out[k + 1] = r[1];
+        } else if constexpr (L == 2) {
+            out[k] = full_result<M>(p, b, raw0, raw1);
+        } else {
+            out[k] = r[L];
+        }
+
+        a[0] = r[p.lane[0].writeback];
+        a[1] = r[p.lane[1].writeback];
     }
 
-    uint32_t uresult0 = shift0 & mask0;
-    uint32_t uresult1 = shift1 & mask1;
+    accum[0] = a[0];
+    accum[1] = a[1];
 
-    bool overf0 = shift0 & ~((1LL << (ctrl0.mask_msb + 1)) - 1);
-    bool overf1 = shift1 & ~((1LL << (ctrl1.mask_msb + 1)) - 1);
-    bool overf = overf0 || overf1;
+    stale = RESULT_ALL;
+    compute(E == InterpEvaluation::EAGER ? RESULT_ALL : 0);
+}
 
-    uint32_t sextmask0 = (shift0 & (1 << ctrl0.mask_msb)) ? (-1U << (ctrl0.mask_msb + 1)) : 0;
-    uint32_t sextmask1 = (shift1 & (1 << ctrl1.mask_msb)) ? (-1U << (ctrl1.mask_msb + 1)) : 0;
+// true if the result of lane i is base[i] + accum[lane.input] for any accum,
+// so that advance() can skip pops by repeated squaring
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr bool InterpSW<N, G, E>::lane_is_affine(const InterpPlan& plan, size_t i) {
+    const InterpLanePlan& lane = plan.lane[i];
 
-    uint32_t sresult0 = uresult0 | sextmask0;
-    uint32_t sresult1 = uresult1 | sextmask1;
+    if (plan.do_blend || (i == 0 && plan.do_clamp) || lane.force_bits) return false;
+    return lane.add_raw || (lane.shift == 0 && lane.mask == ~0U);
+}
 
-    uint32_t result0 = ctrl0.is_signed ? sresult0 : uresult0;
-    uint32_t result1 = ctrl1.is_signed ? sresult1 : uresult1;
+// O(log k) if both written back lanes are affine (no shift, mask, clamp,
+// blend or force bits, or add_raw), otherwise O(k) pops without the stores
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr void InterpSW<N, G, E>::advance(uint64_t k) {
+    if (k == 0) return;
+
+    counter.count([&](InterpStats& s) { s.writebacks += k; });
+    refresh_plan();
+
+    const InterpPlan& p = plan;
+
+    if (lane_is_affine(p, p.lane[0].writeback) && lane_is_affine(p, p.lane[1].writeback)) {
+        // one pop is accum = m * accum + c (mod 2^32), apply it k times by
+        // repeated squaring
+        struct Affine {
+            uint32_t m[2][2];
+            uint32_t c[2];
+
+            constexpr Affine then(const Affine& o) const {
+                Affine r;
+                for (size_t i = 0; i < 2; i++) {
+                    for (size_t j = 0; j < 2; j++) {
+                        r.m[i][j] = o.m[i][0] * m[0][j] + o.m[i][1] * m[1][j];
+                    }
+                    r.c[i] = o.m[i][0] * c[0] + o.m[i][1] * c[1] + o.c[i];
+                }
+                return r;
+            }
+        };
+
+        Affine step = {};
+        for (size_t i = 0; i < 2; i++) {
+            size_t lane = p.lane[i].writeback;
+            step.m[i][p.lane[lane].input] = 1;
+            step.c[i] = base[lane];
+        }
+
+        Affine total = { { { 1, 0 }, { 0, 1 } }, { 0, 0 } };
+        for (; k; k >>= 1) {
+            if (k & 1) total = total.then(step);
+            step = step.then(step);
+        }
+
+        uint32_t a0 = total.m[0][0] * accum[0] + total.m[0][1] * accum[1] + total.c[0];
+        uint32_t a1 = total.m[1][0] * accum[0] + total.m[1][1] * accum[1] + total.c[1];
+        accum[0] = a0;
+        accum[1] = a1;
+    } else {
+        kernel->advance_loop(*this, k);
+    }
 
-    uint32_t addresult0 = base[0] + (ctrl0.add_raw ? input0 : result0);
-    uint32_t addresult1 = base[1] + (ctrl1.add_raw ? input1 : result1);
-    uint32_t addresult2 = base[2] + result0 + (do_blend ? 0 : result1);
+    stale = RESULT_ALL;
+    compute(E == InterpEvaluation::EAGER ? RESULT_ALL : 0);
+}
 
-    auto s32 = sext<int32_t>;
-    uint32_t uclamp0 = result0 < base[0] ? base[0] : (result0 > base[1] ? base[1] : result0);
-    uint32_t sclamp0 = s32(result0) < s32(base[0]) ? base[0] : (s32(result0) > s32(base[1]) ? base[1] : result0);
-    uint32_t clamp0 = ctrl0.is_signed ? sclamp0 : uclamp0;
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+template <uint8_t M>
+constexpr void InterpSW<N, G, E>::advance_loop(uint64_t k) {
+    const InterpPlan p = plan;
+    const uint32_t b[3] = { base[0], base[1], base[2] };
+    uint32_t a[2] = { accum[0], accum[1] };
+
+    for (; k; k--) {
+        uint32_t input0 = a[p.lane[0].input];
+        uint32_t input1 = a[p.lane[1].input];
+        bool overf0, overf1;
+        uint32_t raw0 = lane_raw<(M & InterpPlan::MODE_SIGNED0) != 0>(p.lane[0], input0, overf0);
+        uint32_t raw1 = lane_raw<(M & InterpPlan::MODE_SIGNED1) != 0>(p.lane[1], input1, overf1);
+        uint32_t r[2] = {
+            lane0_result<M>(p, b, input0, raw0, raw1),
+            lane1_result<M>(p, b, input1, raw1),
+        };
+
+        a[0] = r[p.lane[0].writeback];
+        a[1] = r[p.lane[1].writeback];
+    }
 
-    auto u64 = zext<uint64_t>;
-    auto s64 = sext<int64_t>;
-    uint8_t alpha1 = result1;
-    uint32_t ublend1 = base[0] + (alpha1 * (u64(base[1]) - u64(base[0])) >> 8);
-    uint32_t sblend1 = base[0] + (alpha1 * (s64(base[1]) - s64(base[0])) >> 8);
-    uint32_t blend1 = ctrl1.is_signed ? sblend1 : ublend1;
+    accum[0] = a[0];
+    accum[1] = a[1];
+}
 
-    smresult[0] = result0;
-    smresult[1] = result1;
-    result[0] = do_blend ? alpha1 : (do_clamp ? clamp0 : addresult0) | (ctrl0.force_msb << 28);
-    result[1] = (do_blend ? blend1 : addresult1) | (ctrl1.force_msb << 28);
-    result[2] = addresult2;
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr void InterpSW<N, G, E>::update() {
+    refresh_plan();
+    counter.count([&](InterpStats& s) { s.redundant += !stale; });
+    stale = RESULT_ALL;
+    compute(RESULT_ALL);
+}
 
-    ctrl0.overf0 = overf0;
-    ctrl0.overf1 = overf1;
-    ctrl0.overf = overf;
-    ctrl[0] = ctrl0.to();
-    ctrl[1] = ctrl1.to();
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr void InterpSW<N, G, E>::refresh_plan() {
+    if ((ctrl[0] & InterpPlan::CONFIG_BITS) != plan.ctrl[0] || (ctrl[1] & InterpPlan::CONFIG_BITS) != plan.ctrl[1]) {
+        // the first build only counts if CTRL was changed from its reset value
+        counter.count([&](InterpStats& s) { s.ctrl_changes += plan.ctrl[0] != ~0U || (ctrl[0] & InterpPlan::CONFIG_BITS) || (ctrl[1] & InterpPlan::CONFIG_BITS); });
+        plan = InterpPlan::build<N>(ctrl[0], ctrl[1]);
+        kernel = &kernels[plan.mode];
+        stale = RESULT_ALL;
+    }
 }
 
-template <size_t N, InterpGeneration G>
-void InterpSW<N, G>::writeback() {
-    InterpCtrl ctrl0 = InterpCtrl::from(ctrl[0]);
-    InterpCtrl ctrl1 = InterpCtrl::from(ctrl[1]);
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+template <bool Signed>
+constexpr uint32_t InterpSW<N, G, E>::lane_raw(const InterpLanePlan& lane, uint32_t input, bool& overf) {
+    uint32_t shift;
+    switch (G) {
+        case InterpGeneration::RP2040: shift = input >> lane.shift; break;
+        case InterpGeneration::RP2350: shift = std::rotr(input, lane.shift); break;
+    }
 
-    accum[0] = result[ctrl0.cross_result ? 1 : 0];
-    accum[1] = result[ctrl1.cross_result ? 0 : 1];
+    overf = shift & lane.overf_mask;
+    if constexpr (Signed) {
+        return (shift & lane.mask) | ((shift & lane.sign_bit) ? lane.sext_mask : 0);
+    } else {
+        return shift & lane.mask;
+    }
+}
 
-    update();
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+template <uint8_t M>
+constexpr uint32_t InterpSW<N, G, E>::lane0_result(const InterpPlan& plan, const uint32_t (&base)[3], uint32_t input0, uint32_t raw0, uint32_t raw1) {
+    const InterpLanePlan& lane0 = plan.lane[0];
+
+    if constexpr (N == 0 && (M & InterpPlan::MODE_SPECIAL)) {
+        uint8_t alpha1 = raw1;
+        return alpha1;
+    } else if constexpr (N == 1 && (M & InterpPlan::MODE_SPECIAL)) {
+        auto s32 = sext<int32_t>;
+        if constexpr (M & InterpPlan::MODE_SIGNED0) {
+            uint32_t sclamp0 = s32(raw0) < s32(base[0]) ? base[0] : (s32(raw0) > s32(base[1]) ? base[1] : raw0);
+            return sclamp0 | lane0.force_bits;
+        } else {
+            uint32_t uclamp0 = raw0 < base[0] ? base[0] : (raw0 > base[1] ? base[1] : raw0);
+            return uclamp0 | lane0.force_bits;
+        }
+    } else if constexpr (M & InterpPlan::MODE_ADD_RAW0) {
+        return (base[0] + input0) | lane0.force_bits;
+    } else {
+        return (base[0] + raw0) | lane0.force_bits;
+    }
 }
 
-template <size_t N, InterpGeneration G>
-void InterpSW<N, G>::writebase01(uint32_t v) {
-    InterpCtrl ctrl0 = InterpCtrl::from(ctrl[0]);
-    InterpCtrl ctrl1 = InterpCtrl::from(ctrl[1]);
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+template <uint8_t M>
+constexpr uint32_t InterpSW<N, G, E>::lane1_result(const InterpPlan& plan, const uint32_t (&base)[3], uint32_t input1, uint32_t raw1) {
+    const InterpLanePlan& lane1 = plan.lane[1];
+
+    if constexpr (N == 0 && (M & InterpPlan::MODE_SPECIAL)) {
+        auto u64 = zext<uint64_t>;
+        auto s64 = sext<int64_t>;
+        uint8_t alpha1 = raw1;
+        if constexpr (M & InterpPlan::MODE_SIGNED1) {
+            uint32_t sblend1 = base[0] + (alpha1 * (s64(base[1]) - s64(base[0])) >> 8);
+            return sblend1 | lane1.force_bits;
+        } else {
+            uint32_t ublend1 = base[0] + (alpha1 * (u64(base[1]) - u64(base[0])) >> 8);
+            return ublend1 | lane1.force_bits;
+        }
+    } else if constexpr (M & InterpPlan::MODE_ADD_RAW1) {
+        return (base[1] + input1) | lane1.force_bits;
+    } else {
+        return (base[1] + raw1) | lane1.force_bits;
+    }
+}
 
-    bool do_blend = (ctrl0.blend && N == 0);
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+template <uint8_t M>
+constexpr uint32_t InterpSW<N, G, E>::full_result(const InterpPlan&, const uint32_t (&base)[3], uint32_t raw0, uint32_t raw1) {
+    if constexpr (N == 0 && (M & InterpPlan::MODE_SPECIAL)) {
+        return base[2] + raw0;
+    } else {
+        return base[2] + raw0 + raw1;
+    }
+}
+
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr void InterpSW<N, G, E>::compute(uint8_t results) {
+    if (E == InterpEvaluation::EAGER) {
+        results = RESULT_ALL;
+    } else {
+        if (results & (RESULT_LANE0 | RESULT_FULL)) results |= RESULT_RAW0;
+        if (results & (RESULT_LANE1 | RESULT_FULL)) results |= RESULT_RAW1;
+        if ((results & RESULT_LANE0) && plan.do_blend) results |= RESULT_RAW1;
+
+        results &= stale;
+        if (!results) return;
+    }
+
+    counter.count([&](InterpStats& s) { s.updates++; s.redundant += !stale; });
+    stale &= ~results;
+    kernel->compute(*this, results);
+}
+
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+template <uint8_t M>
+constexpr void InterpSW<N, G, E>::compute_kernel(uint8_t results) {
+    const InterpLanePlan& lane0 = plan.lane[0];
+    const InterpLanePlan& lane1 = plan.lane[1];
+
+    uint32_t input0 = accum[lane0.input];
+    uint32_t input1 = accum[lane1.input];
+    const uint32_t prev_overf = ctrl[0] & (InterpPlan::OVERF0_BITS | InterpPlan::OVERF1_BITS);
+    uint32_t overf = prev_overf;
+
+    if (results & RESULT_RAW0) {
+        bool overf0;
+        smresult[0] = lane_raw<(M & InterpPlan::MODE_SIGNED0) != 0>(lane0, input0, overf0);
+        overf = (overf & ~InterpPlan::OVERF0_BITS) | (overf0 ? InterpPlan::OVERF0_BITS : 0);
+    }
+
+    if (results & RESULT_RAW1) {
+        bool overf1;
+        smresult[1] = lane_raw<(M & InterpPlan::MODE_SIGNED1) != 0>(lane1, input1, overf1);
+        overf = (overf & ~InterpPlan::OVERF1_BITS) | (overf1 ? InterpPlan::OVERF1_BITS : 0);
+    }
+
+    if (results & (RESULT_RAW0 | RESULT_RAW1)) {
+        counter.count([&](InterpStats& s) { s.overf_changes += overf != prev_overf; });
+        ctrl[0] = plan.ctrl[0] | overf | (overf ? InterpPlan::OVERF_BITS : 0);
+        ctrl[1] = plan.ctrl[1];
+    }
+
+    if (results & RESULT_LANE0) result[0] = lane0_result<M>(plan, base, input0, smresult[0], smresult[1]);
+    if (results & RESULT_LANE1) result[1] = lane1_result<M>(plan, base, input1, smresult[1]);
+    if (results & RESULT_FULL) result[2] = full_result<M>(plan, base, smresult[0], smresult[1]);
+}
+
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr void InterpSW<N, G, E>::writeback() {
+    counter.count([&](InterpStats& s) { s.writebacks++; });
+    accum[0] = result[plan.lane[0].writeback];
+    accum[1] = result[plan.lane[1].writeback];
+
+    stale = RESULT_ALL;
+    compute(E == InterpEvaluation::EAGER ? RESULT_ALL : 0);
+}
+
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr void InterpSW<N, G, E>::writebase01(uint32_t v) {
+    refresh_plan();
 
     uint16_t input0 = v;
     uint16_t input1 = v >> 16;
@@ -172,17 +581,32 @@ void InterpSW<N, G>::writebase01(uint32_t v) {
     uint32_t sextmask0 = (input0 & (1 << 15)) ? (-1U << 15) : 0;
     uint32_t sextmask1 = (input1 & (1 << 15)) ? (-1U << 15) : 0;
 
-    uint32_t base0 = (do_blend ? ctrl1.is_signed : ctrl0.is_signed) ? input0 | sextmask0 : input0;
-    uint32_t base1 = ctrl1.is_signed ? input1 | sextmask1 : input1;
+    bool signed0 = plan.do_blend ? plan.lane[1].is_signed : plan.lane[0].is_signed;
+    bool signed1 = plan.lane[1].is_signed;
+
+    uint32_t base0 = signed0 ? input0 | sextmask0 : input0;
+    uint32_t base1 = signed1 ? input1 | sextmask1 : input1;
 
     base[0] = base0;
     base[1] = base1;
 
-    update();
+    stale |= RESULT_LANE0 | RESULT_LANE1 | RESULT_FULL;
+    compute(E == InterpEvaluation::EAGER ? RESULT_ALL : 0);
 }
 
-template <size_t N, InterpGeneration G>
-void InterpSW<N, G>::save(InterpState& state) const {
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr void InterpSW<N, G, E>::save(InterpState& state) const {
+    // lazy results may be stale, and computing them also updates the OVERF
+    // flags in ctrl[0], so they are computed on a copy
+    if (E == InterpEvaluation::LAZY && (stale || (ctrl[0] & InterpPlan::CONFIG_BITS) != plan.ctrl[0]
+            || (ctrl[1] & InterpPlan::CONFIG_BITS) != plan.ctrl[1])) {
+        InterpSW current = *this;
+        current.refresh_plan();
+        current.compute(RESULT_ALL);
+        current.save(state);
+        return;
+    }
+
     state.ctrl[0] = ctrl[0];
     state.ctrl[1] = ctrl[1];
     state.accum[0] = accum[0];
@@ -197,8 +621,8 @@ void InterpSW<N, G>::save(InterpState& state) const {
     state.peekraw[1] = smresult[1];
 }
 
-template <size_t N, InterpGeneration G>
-void InterpSW<N, G>::restore(const InterpState& state) {
+template <size_t N, InterpGeneration G, InterpEvaluation E>
+constexpr void InterpSW<N, G, E>::restore(const InterpState& state) {
     ctrl[0] = state.ctrl[0];
     ctrl[1] = state.ctrl[1];
     accum[0] = state.accum[0];
@@ -211,6 +635,7 @@ void InterpSW<N, G>::restore(const InterpState& state) {
     result[2] = state.peek[2];
     smresult[0] = state.peekraw[0];
     smresult[1] = state.peekraw[1];
+    stale = RESULT_ALL;
 }
 
 #endif
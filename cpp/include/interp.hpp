@@ -1,8 +1,11 @@
 #ifndef YRLF_INTERP_HPP_
 #define YRLF_INTERP_HPP_
 
+#include <cstddef>
 #include <cstdint>
 #include <bit>
+#include <concepts>
+#include <span>
 
 enum struct InterpGeneration {
     RP2040,
@@ -14,26 +17,77 @@ enum struct InterpGeneration {
 #endif
 };
 
+enum struct InterpEvaluation {
+    EAGER,
+    LAZY,
+};
+
 struct InterpCtrl {
-    uint32_t shift : 5;
-    uint32_t mask_lsb : 5;
-    uint32_t mask_msb : 5;
-    bool is_signed : 1;
-    bool cross_input : 1;
-    bool cross_result : 1;
-    bool add_raw : 1;
-    uint32_t force_msb : 2;
-    bool blend : 1;
-    bool clamp : 1;
-    bool overf0 : 1;
-    bool overf1 : 1;
-    bool overf : 1;
-    uint32_t _reserved0 : 6;
-
-    static InterpCtrl from(uint32_t v) { return std::bit_cast<InterpCtrl>(v); }
-    uint32_t to() const { return std::bit_cast<uint32_t>(*this); }
+    uint32_t shift : 5 = 0;
+    uint32_t mask_lsb : 5 = 0;
+    uint32_t mask_msb : 5 = 0;
+    bool is_signed : 1 = 0;
+    bool cross_input : 1 = 0;
+    bool cross_result : 1 = 0;
+    bool add_raw : 1 = 0;
+    uint32_t force_msb : 2 = 0;
+    bool blend : 1 = 0;
+    bool clamp : 1 = 0;
+    bool overf0 : 1 = 0;
+    bool overf1 : 1 = 0;
+    bool overf : 1 = 0;
+    uint32_t _reserved0 : 6 = 0;
+
+    constexpr static InterpCtrl from(uint32_t v);
+    constexpr uint32_t to() const;
 };
 
+// std::bit_cast of bit-fields cannot be constant evaluated by all compilers,
+// so constant evaluation packs and unpacks each field by hand
+constexpr InterpCtrl InterpCtrl::from(uint32_t v) {
+    if !consteval {
+        return std::bit_cast<InterpCtrl>(v);
+    }
+
+    InterpCtrl c;
+    c.shift = v & 0x1f;
+    c.mask_lsb = v >> 5 & 0x1f;
+    c.mask_msb = v >> 10 & 0x1f;
+    c.is_signed = v >> 15 & 1;
+    c.cross_input = v >> 16 & 1;
+    c.cross_result = v >> 17 & 1;
+    c.add_raw = v >> 18 & 1;
+    c.force_msb = v >> 19 & 3;
+    c.blend = v >> 21 & 1;
+    c.clamp = v >> 22 & 1;
+    c.overf0 = v >> 23 & 1;
+    c.overf1 = v >> 24 & 1;
+    c.overf = v >> 25 & 1;
+    c._reserved0 = v >> 26;
+    return c;
+}
+
+constexpr uint32_t InterpCtrl::to() const {
+    if !consteval {
+        return std::bit_cast<uint32_t>(*this);
+    }
+
+    return shift
+        | mask_lsb << 5
+        | mask_msb << 10
+        | uint32_t(is_signed) << 15
+        | uint32_t(cross_input) << 16
+        | uint32_t(cross_result) << 17
+        | uint32_t(add_raw) << 18
+        | force_msb << 19
+        | uint32_t(blend) << 21
+        | uint32_t(clamp) << 22
+        | uint32_t(overf0) << 23
+        | uint32_t(overf1) << 24
+        | uint32_t(overf) << 25
+        | _reserved0 << 26;
+}
+
 struct InterpState {
     uint32_t accum[2];
     uint32_t base[3];
@@ -44,10 +98,53 @@ struct InterpState {
     friend bool operator<=>(InterpState, InterpState) = default;
 };
 
+// operation counters of a software interpolator, only counted if
+// RP2040_INTERP_WITH_STATS is set
+struct InterpStats {
+    uint64_t updates = 0;       // datapath evaluations
+    uint64_t redundant = 0;     // evaluations while all cached results were valid
+    uint64_t pops[3] = {};      // pops of lane 0, lane 1 and full
+    uint64_t writebacks = 0;
+    uint64_t ctrl_changes = 0;  // CTRL configuration changes seen by an evaluation
+    uint64_t overf_changes = 0; // evaluations that changed the OVERF flags
+
+    friend bool operator==(const InterpStats&, const InterpStats&) = default;
+};
+
+// API shared by InterpSW, InterpSWC and InterpHW, so code
+// running on any of them can be a template instead of going through virtual
+// calls. Writing accum, base or ctrl directly requires an update() before
+// the next read of a result or of ctrl, all other accesses keep the results
+// valid themselves.
+template <typename T>
+concept InterpBackend = requires(T interp, size_t i, uint32_t v, std::span<uint32_t> out, InterpState& state, const InterpState& cstate) {
+    { interp.accum[i] } -> std::convertible_to<uint32_t>;
+    { interp.base[i] } -> std::convertible_to<uint32_t>;
+    { interp.ctrl[i] } -> std::convertible_to<uint32_t>;
+    interp.accum[i] = v;
+    interp.base[i] = v;
+    interp.ctrl[i] = v;
+    { interp.pop(i) } -> std::same_as<uint32_t>;
+    interp.pop_n(i, out);
+    { interp.peek(i) } -> std::same_as<uint32_t>;
+    { interp.peekraw(i) } -> std::same_as<uint32_t>;
+    interp.add(i, v);
+    interp.base01(v);
+    { interp.read_base01() } -> std::same_as<uint32_t>;
+    interp.update();
+    interp.save(state);
+    interp.restore(cstate);
+    interp = cstate;
+};
+
 #ifndef YRLF_INTERP_SW_HPP_
 #include "interp-sw.hpp"
 #endif
 
+#ifndef YRLF_INTERP_SW_FIXED_HPP_
+#include "interp-sw-fixed.hpp"
+#endif
+
 #if RP2040_INTERP_WITH_C
 #ifndef YRLF_INTERP_SW_C_HPP_
 #include "interp-sw-c.hpp"
@@ -70,4 +167,12 @@ using Interp0 = InterpSW0;
 using Interp1 = InterpSW1;
 #endif
 
+static_assert(InterpBackend<InterpSW0> && InterpBackend<InterpSW1>, "InterpSW is not an InterpBackend");
+#if RP2040_INTERP_WITH_C
+static_assert(InterpBackend<InterpSWC0> && InterpBackend<InterpSWC1>, "InterpSWC is not an InterpBackend");
+#endif
+#if RP2040_INTERP_WITH_HARDWARE
+static_assert(InterpBackend<InterpHW0> && InterpBackend<InterpHW1>, "InterpHW is not an InterpBackend");
+#endif
+
 #endif
@@ -0,0 +1,151 @@
+#include <stdalign.h>
+#include <stdlib.h>
+#include <interp.h>
+#include <interp_vector.h>
+
+// exported entry points for the ctypes backend of the Python library
+//
+// the Python Interp object owns the register values, so every call restores
+// the writable registers from state, runs, and stores the full state back in
+// interp_sw_save_t order
+
+#if defined(_WIN32)
+#define INTERP_NATIVE_EXPORT __declspec(dllexport)
+#else
+#define INTERP_NATIVE_EXPORT __attribute__((visibility("default")))
+#endif
+
+// run_ops op word: register id in bits 7:0, write in bit 8
+#define INTERP_NATIVE_OP_REG_BITS   0x000000ffu
+#define INTERP_NATIVE_OP_WRITE_BITS 0x00000100u
+
+// access digest, same as InterpDigest in the test library
+#define INTERP_NATIVE_DIGEST_WRITE 1u
+#define INTERP_NATIVE_DIGEST_READ  2u
+
+static inline void interp_native_fold(uint64_t *digest, uint32_t op, uint32_t reg, uint32_t value) {
+    uint64_t h = *digest ^ ((uint64_t)(op << 8 | reg) << 32 | value);
+    h *= 0x9e3779b97f4a7c15u;
+    *digest = h ^ (h >> 29);
+}
+
+INTERP_NATIVE_EXPORT interp_sw_core_t *interp_native_new(uint32_t generation) {
+    interp_sw_core_t *core = aligned_alloc(alignof (interp_sw_core_t), sizeof (interp_sw_core_t));
+    if (core != NULL) interp_sw_core_init(core, generation);
+    return core;
+}
+
+INTERP_NATIVE_EXPORT void interp_native_free(interp_sw_core_t *core) {
+    free(core);
+}
+
+static interp_sw_t *interp_native_load(interp_sw_core_t *core, uint32_t n, uint32_t generation, const uint32_t *state) {
+    interp_sw_t *interp = &core->interp[n & 1];
+    interp->generation = generation;
+
+    interp_sw_save_t saver;
+    memcpy(&saver, state, sizeof saver);
+    interp_sw_restore(interp, &saver);
+    return interp;
+}
+
+static void interp_native_store(interp_sw_t *interp, uint32_t *state) {
+    interp_sw_save_t saver;
+    interp_sw_save(interp, &saver);
+    memcpy(state, &saver, sizeof saver);
+}
+
+INTERP_NATIVE_EXPORT void interp_native_update(interp_sw_core_t *core, uint32_t n, uint32_t generation, uint32_t *state) {
+    interp_native_store(interp_native_load(core, n, generation, state), state);
+}
+
+INTERP_NATIVE_EXPORT void interp_native_writeback(interp_sw_core_t *core, uint32_t n, uint32_t generation, uint32_t *state) {
+    interp_sw_t *interp = interp_native_load(core, n, generation, state);
+    interp_sw_writeback(interp);
+    interp_native_store(interp, state);
+}
+
+INTERP_NATIVE_EXPORT void interp_native_base01(interp_sw_core_t *core, uint32_t n, uint32_t generation, uint32_t *state, uint32_t value) {
+    interp_sw_t *interp = interp_native_load(core, n, generation, state);
+    interp_sw_set_base_both(interp, value);
+    interp_native_store(interp, state);
+}
+
+// pops lane 0, lane 1 or full count times
+INTERP_NATIVE_EXPORT void interp_native_pop_many(interp_sw_core_t *core, uint32_t n, uint32_t generation, uint32_t *state, uint32_t lane, uint32_t *out, size_t count, uint64_t *digest) {
+    interp_sw_t *interp = interp_native_load(core, n, generation, state);
+    if (lane == 2) {
+        interp_sw_pop_full_results(interp, out, count);
+    } else {
+        interp_sw_pop_lane_results(interp, lane, out, count);
+    }
+    for (size_t i = 0; i < count; i++) {
+        interp_native_fold(digest, INTERP_NATIVE_DIGEST_READ, INTERP_VECTOR_REG_POP0 + lane, out[i]);
+    }
+    interp_native_store(interp, state);
+}
+
+static uint32_t interp_native_read(interp_sw_t *interp, uint32_t reg) {
+    switch (reg) {
+        case INTERP_VECTOR_REG_POP0: return interp_sw_pop_lane_result(interp, 0);
+        case INTERP_VECTOR_REG_POP1: return interp_sw_pop_lane_result(interp, 1);
+        case INTERP_VECTOR_REG_POP2: return interp_sw_pop_full_result(interp);
+        case INTERP_VECTOR_REG_PEEK0: return interp_sw_peek_lane_result(interp, 0);
+        case INTERP_VECTOR_REG_PEEK1: return interp_sw_peek_lane_result(interp, 1);
+        case INTERP_VECTOR_REG_PEEK2: return interp_sw_peek_full_result(interp);
+        case INTERP_VECTOR_REG_PEEKRAW0: case INTERP_VECTOR_REG_ADD0: return interp_sw_get_raw(interp, 0);
+        case INTERP_VECTOR_REG_PEEKRAW1: case INTERP_VECTOR_REG_ADD1: return interp_sw_get_raw(interp, 1);
+        default:;
+    }
+
+    interp_sw_update_results(interp, INTERP_SW_RESULT_ALL);
+    switch (reg) {
+        case INTERP_VECTOR_REG_ACCUM0: return interp->accum[0];
+        case INTERP_VECTOR_REG_ACCUM1: return interp->accum[1];
+        case INTERP_VECTOR_REG_BASE0: return interp->base[0];
+        case INTERP_VECTOR_REG_BASE1: return interp->base[1];
+        case INTERP_VECTOR_REG_BASE2: return interp->base[2];
+        case INTERP_VECTOR_REG_CTRL0: return interp->ctrl[0];
+        case INTERP_VECTOR_REG_CTRL1: return interp->ctrl[1];
+        default: return 0;
+    }
+}
+
+static void interp_native_write(interp_sw_t *interp, uint32_t reg, uint32_t value) {
+    switch (reg) {
+        case INTERP_VECTOR_REG_ACCUM0: interp_sw_set_accumulator(interp, 0, value); break;
+        case INTERP_VECTOR_REG_ACCUM1: interp_sw_set_accumulator(interp, 1, value); break;
+        case INTERP_VECTOR_REG_BASE0: interp_sw_set_base(interp, 0, value); break;
+        case INTERP_VECTOR_REG_BASE1: interp_sw_set_base(interp, 1, value); break;
+        case INTERP_VECTOR_REG_BASE2: interp_sw_set_base(interp, 2, value); break;
+        case INTERP_VECTOR_REG_CTRL0: interp->ctrl[0] = value; interp->stale = INTERP_SW_RESULT_ALL; break;
+        case INTERP_VECTOR_REG_CTRL1: interp->ctrl[1] = value; interp->stale = INTERP_SW_RESULT_ALL; break;
+        case INTERP_VECTOR_REG_ADD0: interp_sw_add_accumulator(interp, 0, value); break;
+        case INTERP_VECTOR_REG_ADD1: interp_sw_add_accumulator(interp, 1, value); break;
+        case INTERP_VECTOR_REG_BASE01: interp_sw_set_base_both(interp, value); return;
+        default: return;
+    }
+    interp_sw_update_results(interp, INTERP_SW_RESULT_ALL);
+}
+
+// runs count register accesses, values holds the written values and
+// receives the read values
+INTERP_NATIVE_EXPORT void interp_native_run_ops(interp_sw_core_t *core, uint32_t n, uint32_t generation, uint32_t *state, const uint32_t *ops, uint32_t *values, size_t count, uint64_t *digest) {
+    interp_sw_t *interp = interp_native_load(core, n, generation, state);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t reg = ops[i] & INTERP_NATIVE_OP_REG_BITS;
+        if (ops[i] & INTERP_NATIVE_OP_WRITE_BITS) {
+            interp_native_write(interp, reg, values[i]);
+            // writes to read-only registers are skipped
+            if (reg < INTERP_VECTOR_REG_POP0 || reg > INTERP_VECTOR_REG_PEEKRAW1) {
+                interp_native_fold(digest, INTERP_NATIVE_DIGEST_WRITE, reg, values[i]);
+            }
+        } else {
+            values[i] = interp_native_read(interp, reg);
+            // reads of ADD0/ADD1 are folded as PEEKRAW0/PEEKRAW1
+            uint32_t digest_reg = reg == INTERP_VECTOR_REG_ADD0 ? INTERP_VECTOR_REG_PEEKRAW0 : reg == INTERP_VECTOR_REG_ADD1 ? INTERP_VECTOR_REG_PEEKRAW1 : reg;
+            interp_native_fold(digest, INTERP_NATIVE_DIGEST_READ, digest_reg, values[i]);
+        }
+    }
+    interp_native_store(interp, state);
+}
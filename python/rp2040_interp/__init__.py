@@ -1 +1,2 @@
-from .interp import InterpGeneration, InterpCtrl, InterpState, Interp
+from .interp import InterpGeneration, InterpCtrl, InterpState, Interp, native_available
+from .vectors import InterpVector, InterpVectorCorpus
@@ -0,0 +1,246 @@
+from __future__ import annotations
+from typing import Iterable
+import numpy as np
+from .interp import Interp, InterpGeneration, InterpState
+
+M32 = 0xffffffff
+
+ArrayLike = int | np.ndarray
+
+def _u32(v: ArrayLike) -> np.ndarray:
+    if isinstance(v, int):
+        v &= M32
+    return (np.asarray(v).astype(np.int64) & M32).astype(np.uint32)
+
+def _s32(v: np.ndarray) -> np.ndarray:
+    return v.astype(np.uint32).view(np.int32).astype(np.int64)
+
+def _bit(v: np.ndarray, b: int) -> np.ndarray:
+    return ((v >> b) & 1).astype(bool)
+
+class InterpArray:
+    """
+    Vectorized software simulation of many interpolators with the same n and
+    generation, each element bit-exact with Interp.
+    Registers are uint32 arrays of shape (count, size), e.g. accum[0] holds
+    ACCUM0 of all elements. Values can be scalars or arrays of length size.
+    """
+    n: int
+    generation: InterpGeneration
+    accum: np.ndarray # shape = (2, size)
+    base: np.ndarray  # shape = (3, size)
+    ctrl: np.ndarray  # shape = (2, size)
+
+    _smresult: np.ndarray # shape = (2, size)
+    _result: np.ndarray   # shape = (3, size)
+
+    def __init__(self, size: int, n: int = 0, generation: InterpGeneration = InterpGeneration.RP2040):
+        """
+        Construct size interpolators in reset state
+        """
+        assert n in [0, 1], "invalid interpolator index"
+        self.n = n
+        self.generation = generation
+        self.accum = np.zeros((2, size), dtype = np.uint32)
+        self.base = np.zeros((3, size), dtype = np.uint32)
+        self.ctrl = np.zeros((2, size), dtype = np.uint32)
+        self._smresult = np.zeros((2, size), dtype = np.uint32)
+        self._result = np.zeros((3, size), dtype = np.uint32)
+        self.update()
+
+    @staticmethod
+    def from_states(states: Iterable[InterpState], n: int = 0, generation: InterpGeneration = InterpGeneration.RP2040) -> InterpArray:
+        """
+        Construct one interpolator per state, like Interp.restore()
+        """
+        states = list(states)
+        array = InterpArray(len(states), n, generation)
+        array.accum[:] = np.array([s.accum for s in states], dtype = np.int64).T & M32
+        array.base[:] = np.array([s.base for s in states], dtype = np.int64).T & M32
+        array.ctrl[:] = np.array([s.ctrl for s in states], dtype = np.int64).T & M32
+        array.update()
+        return array
+
+    @staticmethod
+    def random(size: int, n: int = 0, generation: InterpGeneration = InterpGeneration.RP2040, rng: np.random.Generator | None = None) -> InterpArray:
+        """
+        Construct size interpolators with random registers, like
+        InterpState.random()
+        """
+        rng = rng or np.random.default_rng()
+        array = InterpArray(size, n, generation)
+        array.accum[:] = rng.integers(0, 1 << 32, (2, size), dtype = np.uint32, endpoint = False)
+        array.base[:] = rng.integers(0, 1 << 32, (3, size), dtype = np.uint32, endpoint = False)
+        array.ctrl[:] = rng.integers(0, 1 << 32, (2, size), dtype = np.uint32, endpoint = False)
+        array.update()
+        return array
+
+    def __len__(self) -> int:
+        return self.accum.shape[1]
+
+    def set_accum(self, i: int, v: ArrayLike):
+        """
+        Set an accumulator register and update
+        """
+        self.accum[i] = _u32(v)
+        self.update()
+
+    def set_base(self, i: int, v: ArrayLike):
+        """
+        Set a base register and update
+        """
+        self.base[i] = _u32(v)
+        self.update()
+
+    def set_ctrl(self, i: int, v: ArrayLike):
+        """
+        Set a ctrl register and update
+        """
+        self.ctrl[i] = _u32(v)
+        self.update()
+
+    def pop(self, i: int) -> np.ndarray:
+        """
+        Read a pop register of all interpolators.
+        This changes the interpolator states.
+        """
+        self.update()
+        v = self._result[i].copy()
+        self._writeback()
+        return v
+
+    def peek(self, i: int) -> np.ndarray:
+        """
+        Read a peek register of all interpolators.
+        """
+        self.update()
+        return self._result[i].copy()
+
+    def peekraw(self, i: int) -> np.ndarray:
+        """
+        Read a raw lane result register of all interpolators.
+        """
+        self.update()
+        return self._smresult[i].copy()
+
+    def add(self, i: int, v: ArrayLike):
+        """
+        Add to the accumulators of all interpolators.
+        """
+        self.accum[i] += _u32(v)
+        self.update()
+
+    def base01(self, v: ArrayLike):
+        """
+        Write to the base01 register of all interpolators.
+        """
+        v = _u32(v).astype(np.int64)
+        do_blend = _bit(self.ctrl[0], 21) & (self.n == 0)
+        signed0 = np.where(do_blend, _bit(self.ctrl[1], 15), _bit(self.ctrl[0], 15))
+        signed1 = _bit(self.ctrl[1], 15)
+
+        input0 = v & 0xffff
+        input1 = (v >> 16) & 0xffff
+        sext0 = np.where(input0 & 0x8000, 0xffff8000, 0)
+        sext1 = np.where(input1 & 0x8000, 0xffff8000, 0)
+
+        self.base[0] = np.where(signed0, input0 | sext0, input0)
+        self.base[1] = np.where(signed1, input1 | sext1, input1)
+        self.update()
+
+    def update(self):
+        """
+        Update the interpolator results, same as Interp.update()
+        """
+        ctrl0 = self.ctrl[0].astype(np.int64)
+        ctrl1 = self.ctrl[1].astype(np.int64)
+        accum0 = self.accum[0].astype(np.int64)
+        accum1 = self.accum[1].astype(np.int64)
+        base0 = self.base[0].astype(np.int64)
+        base1 = self.base[1].astype(np.int64)
+        base2 = self.base[2].astype(np.int64)
+
+        do_clamp = _bit(ctrl0, 22) & (self.n == 1)
+        do_blend = _bit(ctrl0, 21) & (self.n == 0)
+
+        def lane(ctrl: np.ndarray, input: np.ndarray) -> tuple[np.ndarray, np.ndarray]:
+            shift = ctrl & 0x1f
+            mask_lsb = (ctrl >> 5) & 0x1f
+            mask_msb = (ctrl >> 10) & 0x1f
+
+            match self.generation:
+                case InterpGeneration.RP2040:
+                    shifted = input >> shift
+                case InterpGeneration.RP2350:
+                    shifted = ((input >> shift) | (input << (32 - shift))) & M32
+
+            upper = (1 << (mask_msb + 1)) - 1
+            uresult = shifted & upper & ~((1 << mask_lsb) - 1)
+            overf = (shifted & ~upper) != 0
+            sextmask = np.where((shifted >> mask_msb) & 1, ~upper & M32, 0)
+            result = np.where(_bit(ctrl, 15), uresult | sextmask, uresult)
+            return result, overf
+
+        input0 = np.where(_bit(ctrl0, 16), accum1, accum0)
+        input1 = np.where(_bit(ctrl1, 16), accum0, accum1)
+        result0, overf0 = lane(ctrl0, input0)
+        result1, overf1 = lane(ctrl1, input1)
+
+        addresult0 = (base0 + np.where(_bit(ctrl0, 18), input0, result0)) & M32
+        addresult1 = (base1 + np.where(_bit(ctrl1, 18), input1, result1)) & M32
+        addresult2 = (base2 + result0 + result1) & M32
+
+        uclamp0 = np.where(result0 < base0, base0, np.where(result0 > base1, base1, result0))
+        sclamp0 = np.where(_s32(result0) < _s32(base0), base0, np.where(_s32(result0) > _s32(base1), base1, result0))
+        clamp0 = np.where(_bit(ctrl0, 15), sclamp0, uclamp0)
+
+        alpha1 = result1 & 0xff
+        ublend1 = base0 + ((alpha1 * (base1 - base0)) >> 8)
+        sblend1 = _s32(base0) + ((alpha1 * (_s32(base1) - _s32(base0))) >> 8)
+        blend1 = np.where(_bit(ctrl1, 15), sblend1, ublend1) & M32
+
+        force0 = ((ctrl0 >> 19) & 0b11) << 28
+        force1 = ((ctrl1 >> 19) & 0b11) << 28
+
+        self._smresult[0] = result0
+        self._smresult[1] = result1
+        self._result[0] = np.where(do_blend, alpha1, np.where(do_clamp, clamp0, addresult0) | force0)
+        self._result[1] = np.where(do_blend, blend1, addresult1) | force1
+        self._result[2] = np.where(do_blend, (base2 + result0) & M32, addresult2)
+
+        # drop reserved bits and settings of the other interpolator, and
+        # set the overflow flags of ctrl0
+        ctrl0 = (ctrl0 & 0x001fffff) | np.where(do_blend, 1 << 21, 0) | np.where(do_clamp, 1 << 22, 0)
+        ctrl0 |= (overf0 << 23) | (overf1 << 24) | ((overf0 | overf1) << 25)
+        self.ctrl[0] = ctrl0
+        self.ctrl[1] = ctrl1 & 0x001fffff
+
+    def _writeback(self):
+        cross0 = _bit(self.ctrl[0], 17)
+        cross1 = _bit(self.ctrl[1], 17)
+        accum0 = np.where(cross0, self._result[1], self._result[0])
+        accum1 = np.where(cross1, self._result[0], self._result[1])
+        self.accum[0] = accum0
+        self.accum[1] = accum1
+        self.update()
+
+    def state(self, k: int) -> InterpState:
+        """
+        Save the state of interpolator k, same as Interp.save()
+        """
+        self.update()
+        return InterpState(
+            accum = [int(v) for v in self.accum[:, k]],
+            base = [int(v) for v in self.base[:, k]],
+            ctrl = [int(v) for v in self.ctrl[:, k]],
+            peek = [int(v) for v in self._result[:, k]],
+            peekraw = [int(v) for v in self._smresult[:, k]],
+        )
+
+    def interp(self, k: int) -> Interp:
+        """
+        Construct an Interp with the state of interpolator k
+        """
+        interp = Interp(self.n, self.generation)
+        interp.restore(self.state(k))
+        return interp
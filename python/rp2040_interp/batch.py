@@ -0,0 +1,174 @@
+from __future__ import annotations
+from typing import BinaryIO
+import struct
+import sys
+from .interp import InterpState, REGS
+
+# binary batch protocol, see InterpBatchHeader in tests/lib/include/interp-test.hpp
+SYNC = 0xb1
+VERSION = 1
+MAX_OPS = 1024
+MAX_WORDS = 4096
+
+OP_WRITE = 0
+OP_READ = 1
+OP_DUMP = 2
+OP_DIGEST = 3
+
+STATUS_OK = 0
+STATUS_INVALID = 1
+STATUS_FULL = 2
+
+HEADER = struct.Struct("<BBH")
+RECORD = struct.Struct("<BBBxI")
+RESPONSE = struct.Struct("<BBHI")
+
+class InterpBatchError(Exception):
+    pass
+
+class InterpBatch:
+    """
+    Collects register accesses to run on a tester in one round trip
+    """
+    ops: list[tuple[int, int, int, int]]
+    words: int
+
+    def __init__(self):
+        self.ops = []
+        self.words = 0
+
+    def _add(self, op: int, n: int, reg: str | None, value: int, words: int):
+        if len(self.ops) >= MAX_OPS or self.words + words > MAX_WORDS:
+            raise InterpBatchError("batch is full")
+        self.ops.append((op, 0 if reg is None else REGS.index(reg), n, value))
+        self.words += words
+
+    def write(self, n: int, reg: str, value: int):
+        """
+        Write a register, e.g. "ctrl0"
+        """
+        self._add(OP_WRITE, n, reg, value & 0xffffffff, 0)
+
+    def read(self, n: int, reg: str):
+        """
+        Read a register, e.g. "pop0"
+        """
+        self._add(OP_READ, n, reg, 0, 1)
+
+    def dump(self, n: int):
+        """
+        Read the state of an interpolator
+        """
+        self._add(OP_DUMP, n, None, 0, 12)
+
+    def digest(self, n: int):
+        """
+        Read the access digest of an interpolator, see Interp.digest()
+        """
+        self._add(OP_DIGEST, n, None, 0, 2)
+
+    def encode(self) -> bytes:
+        """
+        Encode the batch as request frame
+        """
+        return HEADER.pack(SYNC, VERSION, len(self.ops)) + b"".join(RECORD.pack(*op) for op in self.ops)
+
+    def run(self, output: BinaryIO, input: BinaryIO | None = None) -> list[int | InterpState | None]:
+        """
+        Send the batch to output and wait for its response on input (or
+        output, e.g. for a serial port)
+
+        Returns one result per op: None for writes, the value for reads and
+        digests and an InterpState for dumps
+        """
+        input = input or output
+        output.write(self.encode())
+        output.flush()
+        return self.decode(input.read(RESPONSE.size), input.read)
+
+    def decode(self, header: bytes, read) -> list[int | InterpState | None]:
+        """
+        Decode a response frame, reading the values with read(size)
+        """
+        if len(header) != RESPONSE.size:
+            raise InterpBatchError("connection closed")
+        sync, status, count, words = RESPONSE.unpack(header)
+        data = read(words * 4) if words else b""
+        if sync != SYNC or len(data) != words * 4:
+            raise InterpBatchError("invalid response frame")
+        if status != STATUS_OK or count != len(self.ops):
+            raise InterpBatchError(f"batch failed at op {count} with status {status}")
+
+        values = struct.unpack(f"<{words}I", data)
+        results = []
+        i = 0
+        for op, _, _, _ in self.ops:
+            if op == OP_READ:
+                results.append(values[i])
+                i += 1
+            elif op == OP_DUMP:
+                v = list(values[i:i + 12])
+                results.append(InterpState(accum = v[0:2], base = v[2:5], ctrl = v[5:7], peek = v[7:10], peekraw = v[10:12]))
+                i += 12
+            elif op == OP_DIGEST:
+                results.append(values[i] | values[i + 1] << 32)
+                i += 2
+            else:
+                results.append(None)
+        return results
+
+def _check_resync(output: BinaryIO, input: BinaryIO):
+    """
+    Check that an oversized batch is rejected without desynchronizing the
+    stream, i.e. the next batch is answered normally
+    """
+    oversized = HEADER.pack(SYNC, VERSION, MAX_OPS + 1) + RECORD.pack(OP_READ, 0, 0, 0) * (MAX_OPS + 1)
+    output.write(oversized)
+    output.flush()
+    sync, status, count, words = RESPONSE.unpack(input.read(RESPONSE.size))
+    if (sync, status, count, words) != (SYNC, STATUS_INVALID, 0, 0):
+        raise InterpBatchError(f"oversized batch: unexpected response {status=} {count=} {words=}")
+
+    batch = InterpBatch()
+    batch.write(0, "accum0", 0x1234)
+    batch.read(0, "accum0")
+    if batch.run(output, input) != [None, 0x1234]:
+        raise InterpBatchError("batch after an oversized batch failed")
+
+def _benchmark(host_test: str, count: int):
+    """
+    Compare text commands with binary batches on a host-test binary
+    """
+    import subprocess
+    import time
+
+    proc = subprocess.Popen([host_test], stdin = subprocess.PIPE, stdout = subprocess.PIPE)
+    _check_resync(proc.stdin, proc.stdout)
+
+    start = time.perf_counter()
+    for i in range(count):
+        proc.stdin.write(b"read 0 pop0\n")
+        proc.stdin.flush()
+        proc.stdout.readline()
+    text = time.perf_counter() - start
+
+    start = time.perf_counter()
+    done = 0
+    while done < count:
+        batch = InterpBatch()
+        for i in range(min(MAX_OPS, count - done)):
+            batch.read(0, "pop0")
+        batch.run(proc.stdin, proc.stdout)
+        done += len(batch.ops)
+    binary = time.perf_counter() - start
+
+    proc.stdin.close()
+    proc.wait()
+    print(f"text:   {count} ops in {text:.3f} s, {count / text:.0f} ops/s")
+    print(f"binary: {count} ops in {binary:.3f} s, {count / binary:.0f} ops/s")
+
+if __name__ == "__main__":
+    if len(sys.argv) not in (2, 3):
+        print("usage: python -m rp2040_interp.batch HOST_TEST [COUNT]", file = sys.stderr)
+        sys.exit(2)
+    _benchmark(sys.argv[1], int(sys.argv[2]) if len(sys.argv) == 3 else 100000)
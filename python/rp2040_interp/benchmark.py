@@ -0,0 +1,58 @@
+import sys
+import time
+from .interp import Interp, InterpState, native_available
+
+def _benchmark(count: int):
+    """
+    Compare the pure Python and the native backend, and InterpArray over
+    count random states if NumPy is installed
+    """
+    def timed(name: str, fn, unit: str = "ops") -> float:
+        start = time.perf_counter()
+        fn()
+        seconds = time.perf_counter() - start
+        print(f"{name:24} {count} {unit} in {seconds:.3f} s, {count / seconds:.0f} {unit}/s")
+        return seconds
+
+    ops = [("add0", 3), ("pop0", None), ("peek1", None), ("pop2", None)] * (count // 4)
+    for native in (False, True) if native_available() else (False,):
+        print("native:" if native else "pure python:")
+        interp = Interp(0, native = native)
+        interp.set_ctrl(0, 0x7c04)
+        interp.set_ctrl(1, 0x7c00)
+        interp.set_base(0, 1)
+        timed("pop", lambda: [interp.pop(0) for _ in range(count)])
+        timed("pop_many", lambda: interp.pop_many(0, count))
+        timed("run_ops", lambda: interp.run_ops(ops))
+
+    try:
+        from .array import InterpArray
+    except ImportError:
+        print("numpy not installed, skipping InterpArray")
+        return
+
+    # the same op sequence on every state, one Interp at a time or vectorized
+    states = [InterpState.random() for _ in range(count)]
+    def sweep():
+        for state in states:
+            interp = Interp(0)
+            interp.restore(state)
+            interp.add(0, 3)
+            interp.pop(0)
+            interp.pop(2)
+    def sweep_array():
+        array = InterpArray.from_states(states)
+        array.add(0, 3)
+        array.pop(0)
+        array.pop(2)
+    print("state sweep:")
+    timed("Interp", sweep, "states")
+    timed("InterpArray", sweep_array, "states")
+
+if __name__ == "__main__":
+    if not native_available():
+        print("native backend not available, build with -DRP2040_INTERP_WITH_PYTHON=ON and set RP2040_INTERP_NATIVE")
+    if len(sys.argv) > 2:
+        print("usage: python -m rp2040_interp.benchmark [COUNT]", file = sys.stderr)
+        sys.exit(2)
+    _benchmark(int(sys.argv[1]) if len(sys.argv) == 2 else 100000)
@@ -1,39 +1,87 @@
-from typing import override
-from serial import Serial
+from __future__ import annotations
+import os
+import select
+from collections import deque
+from contextlib import contextmanager, nullcontext
 from pathlib import Path
+from typing import Any, Callable, Iterable, Iterator
 from .interp import Interp, InterpState, InterpGeneration
+from .batch import InterpBatch
+
+try:
+    from typing import override
+except ImportError:
+    # python < 3.12
+    def override(f):
+        return f
 
 def _hex_values(values: list[int]) -> str:
     return " ".join(hex(v) for v in values)
 
+def _values_state(values: list[int]) -> InterpState:
+    return InterpState(
+        accum = values[0:2],
+        base = values[2:5],
+        ctrl = values[5:7],
+        peek = values[7:10],
+        peekraw = values[10:12]
+    )
+
+class InterpPending:
+    """
+    Result of a read sent inside InterpHW.pipeline(), available once its
+    response has been received
+    """
+    def __init__(self, owner: InterpHW):
+        self._owner = owner
+        self._done = False
+        self._value = None
+
+    @property
+    def value(self) -> Any:
+        """
+        The result, waits for all commands sent so far if necessary
+        """
+        if not self._done:
+            self._owner.flush()
+        return self._value
+
+    def __repr__(self) -> str:
+        return f"InterpPending({self._value!r})" if self._done else "InterpPending(...)"
+
 class InterpHW(Interp):
     """
     Represents a connection to a Raspberry Pi Pico running the pico-test-hw firmware
     Allows a hardware interpolator to be used from host Python
     """
-    serial: Serial
+    serial: Any
     debug: bool
+    window: int
 
-    def __init__(self, n: int = 0, generation: InterpGeneration | None = None, port: Path = Path("/dev/ttyACM0"), debug: bool = False):
+    def __init__(self, n: int = 0, generation: InterpGeneration | None = None, port: Path = Path("/dev/ttyACM0"), debug: bool = False, serial: Any = None):
         """
         Construct a hardware interpolator peripheral proxy
         """
         super().__init__(n, generation or InterpGeneration.RP2040)
-        self.serial = Serial(str(port), 115200)
+        if serial is None:
+            from serial import Serial
+            serial = Serial(str(port), 115200)
+        self.serial = serial
         self.debug = debug
+        self.window = 256
+
+        # pipelined commands not yet written, and written commands waiting
+        # for their response
+        self._pipeline_depth = 0
+        self._queued = deque()
+        self._inflight = deque()
+        self._error = None
 
         if generation is None:
             self.generation = self._send_cmd_generation("generation 0")
             self.update()
 
-    def _send_cmd_raw(self, cmd: str) -> tuple[str, list[int] | str]:
-        if self.debug:
-            print(f"<< {cmd}")
-        self.serial.write(cmd.encode() + b"\n")
-        line = self.serial.readline().decode().strip()
-        if self.debug:
-            print(f">> {line}")
-
+    def _parse_response(self, line: str) -> tuple[str, list[int] | str]:
         parts = line.split(" ", 1)
         word, rest = parts[0], ("" if len(parts) == 1 else parts[1])
         if word == "syntax":
@@ -52,6 +100,19 @@ class InterpHW(Interp):
 
         return word, values
 
+    def _readline(self) -> str:
+        line = self.serial.readline().decode().strip()
+        if self.debug:
+            print(f">> {line}")
+        return line
+
+    def _send_cmd_raw(self, cmd: str) -> tuple[str, list[int] | str]:
+        self.flush()
+        if self.debug:
+            print(f"<< {cmd}")
+        self.serial.write(cmd.encode() + b"\n")
+        return self._parse_response(self._readline())
+
     def _send_cmd_generation(self, cmd: str) -> InterpGeneration:
         word, gen = self._send_cmd_raw(cmd)
         if word != "generation" and gen not in ("RP2040", "RP2350"):
@@ -62,39 +123,131 @@ class InterpHW(Interp):
         else:
             return InterpGeneration.RP2350
 
-    def _send_cmd_ok(self, cmd: str):
-        word, values = self._send_cmd_raw(cmd)
+    def _check_ok(self, word: str, values: list[int]):
         if word != "ok" or len(values) != 0:
             raise ValueError(f"expected 'ok', got '{word} {_hex_values(values)}'")
 
-    def _send_cmd_n(self, cmd: str, expected_cmd: str, n: int) -> list[int]:
-        word, values = self._send_cmd_raw(cmd)
+    def _check_n(self, word: str, values: list[int], expected_cmd: str, n: int) -> list[int]:
         if word != expected_cmd or len(values) != n:
-            raise ValueError(f"expected 'data' with {n} value(s), got '{word} {rest}'")
-
+            raise ValueError(f"expected '{expected_cmd}' with {n} value(s), got '{word} {_hex_values(values)}'")
         return values
 
-    def _send_cmd_data(self, cmd: str) -> int:
-        return self._send_cmd_n(cmd, "data", 1)[0]
+    def _submit(self, cmd: str, check: Callable[[str, list[int]], Any], pending: bool) -> Any:
+        """
+        Send a command, returning its checked result, or an InterpPending if
+        pipelining
+        """
+        if self._pipeline_depth == 0:
+            return check(*self._send_cmd_raw(cmd))
+
+        if self.debug:
+            print(f"<< {cmd}")
+        result = InterpPending(self) if pending else None
+        self._queued.append((cmd.encode() + b"\n", check, result))
+        if len(self._queued) >= self.window:
+            self._write_pipelined()
+        return result
+
+    def _send_cmd_ok(self, cmd: str):
+        self._submit(cmd, self._check_ok, False)
+
+    def _send_cmd_n(self, cmd: str, expected_cmd: str, n: int) -> list[int] | InterpPending:
+        return self._submit(cmd, lambda word, values: self._check_n(word, values, expected_cmd, n), True)
+
+    def _send_cmd_data(self, cmd: str) -> int | InterpPending:
+        return self._submit(cmd, lambda word, values: self._check_n(word, values, "data", 1)[0], True)
+
+    def _receive_pipelined(self):
+        """
+        Match one response to the oldest command waiting for it
+        """
+        check, result = self._inflight.popleft()
+        try:
+            value = check(*self._parse_response(self._readline()))
+        except (ValueError, SyntaxError) as e:
+            # keep reading, so responses stay matched to their commands
+            self._error = self._error or e
+            value = None
+        if result is not None:
+            result._value = value
+            result._done = True
+
+    def _write_pipelined(self):
+        """
+        Write all queued commands in bulk, keeping at most window commands
+        without response, and match the responses that already arrived
+        """
+        while self._queued:
+            while len(self._inflight) >= self.window:
+                self._receive_pipelined()
+
+            count = min(len(self._queued), self.window - len(self._inflight))
+            out = bytearray()
+            for _ in range(count):
+                line, check, result = self._queued.popleft()
+                out += line
+                self._inflight.append((check, result))
+            self.serial.write(bytes(out))
+
+        while self._inflight and getattr(self.serial, "in_waiting", 0) > 0:
+            self._receive_pipelined()
+
+    def flush(self):
+        """
+        Send all pipelined commands and wait for their responses.
+        Raises the first error of a failed command.
+        """
+        self._write_pipelined()
+        while self._inflight:
+            self._receive_pipelined()
+
+        error, self._error = self._error, None
+        if error is not None:
+            raise error
+
+    @contextmanager
+    def pipeline(self, window: int | None = None) -> Iterator[InterpHW]:
+        """
+        Queue commands instead of waiting for each response.
+        Reads return an InterpPending, which is resolved once its response
+        arrived, at the latest when the block ends. Errors are raised when
+        the block ends or on InterpPending.value. If the block raises, the
+        responses are still received, but command errors are dropped in
+        favor of the exception of the block. window applies to this block
+        only.
+        """
+        previous_window = self.window
+        if window is not None:
+            self.window = max(1, window)
+        self._pipeline_depth += 1
+        failed = False
+        try:
+            yield self
+        except BaseException:
+            failed = True
+            raise
+        finally:
+            self._pipeline_depth -= 1
+            try:
+                if self._pipeline_depth == 0:
+                    self.flush()
+            except Exception:
+                if not failed:
+                    raise
+            finally:
+                self.window = previous_window
 
     def _write_reg(self, reg: str, v: int):
         self._send_cmd_ok(f"write {self.n} {reg} {v:#x}")
 
-    def _read_reg(self, reg: str) -> int:
+    def _read_reg(self, reg: str) -> int | InterpPending:
         return self._send_cmd_data(f"read {self.n} {reg}")
 
     def _write_state(self, state: InterpState):
         self._send_cmd_ok(f"state {self.n} {state.accum[0]:#x} {state.accum[1]:#x} {state.base[0]:#x} {state.base[1]:#x} {state.base[2]:#x} {state.ctrl[0]:#x} {state.ctrl[1]:#x}")
 
-    def _read_state(self) -> InterpState:
-        values = self._send_cmd_n(f"dump {self.n}", "data", 12)
-        return InterpState(
-            accum = values[0:2],
-            base = values[2:5],
-            ctrl = values[5:7],
-            peek = values[7:10],
-            peekraw = values[10:12]
-        )
+    def _read_state(self) -> InterpState | InterpPending:
+        return self._submit(f"dump {self.n}", lambda word, values: _values_state(self._check_n(word, values, "data", 12)), True)
 
     @override
     def set_accum(self, i: int, v: int):
@@ -158,9 +311,43 @@ class InterpHW(Interp):
         """
         Write to the base01 register of the interpolator.
         """
-        super().base01(i, v)
+        super().base01(v)
         return self._write_reg("base01", v)
 
+    @override
+    def pop_many(self, i: int, count: int) -> list[int | InterpPending]:
+        """
+        Read a pop register count times, one command each.
+        Use pipeline() to avoid waiting for each response.
+        """
+        return [self.pop(i) for _ in range(count)]
+
+    @override
+    def run_ops(self, ops: Iterable[tuple[str, int | None]]) -> list[int | InterpPending | None]:
+        """
+        Run register accesses given as (register, value) pairs, one command
+        each. Use pipeline() to avoid waiting for each response.
+        """
+        return [self._run_op(reg, value) for reg, value in ops]
+
+    @override
+    def _run_op(self, reg: str, value: int | None) -> int | InterpPending | None:
+        result = super()._run_op(reg, value)
+        if value is None and reg.startswith(("accum", "base", "ctrl")):
+            return self._read_reg(reg)
+        return result
+
+    @override
+    def digest(self, sw: bool = False) -> int | InterpPending:
+        """
+        Digest of all register accesses so far and the current state.
+        Pass sw=True to get the digest of the software simulation.
+        """
+        if sw:
+            return super().digest()
+        else:
+            return self._send_cmd_data(f"digest {self.n}")
+
     @override
     def save(self, sw: bool = False) -> InterpState:
         """
@@ -181,6 +368,15 @@ class InterpHW(Interp):
         super().restore(state)
         self._write_state(state)
 
+    def run_batch(self, batch: InterpBatch) -> list[int | InterpState | None]:
+        """
+        Run a batch of register accesses in one round trip.
+        Pipelined commands are flushed first, so their responses are not
+        read as the batch response. The software simulation is not updated.
+        """
+        self.flush()
+        return batch.run(self.serial)
+
     @override
     def diff(self) -> InterpState:
         """
@@ -188,4 +384,157 @@ class InterpHW(Interp):
         """
         sw_state = self.save(sw = True)
         hw_state = self.save(sw = False)
+        if isinstance(hw_state, InterpPending):
+            hw_state = hw_state.value
         return sw_state ^ hw_state
+
+
+class _PtySerial:
+    """
+    Minimal serial port stand-in over a pseudo terminal
+    """
+    def __init__(self, fd: int):
+        self.fd = fd
+        self.buffer = bytearray()
+
+    def write(self, data: bytes):
+        view = memoryview(data)
+        while view:
+            view = view[os.write(self.fd, view):]
+
+    def flush(self):
+        pass
+
+    def read(self, size: int) -> bytes:
+        while len(self.buffer) < size:
+            self.buffer += os.read(self.fd, 1 << 16)
+        data = bytes(self.buffer[:size])
+        del self.buffer[:size]
+        return data
+
+    def readline(self) -> bytes:
+        while (end := self.buffer.find(b"\n")) < 0:
+            self.buffer += os.read(self.fd, 1 << 16)
+        line = bytes(self.buffer[:end + 1])
+        del self.buffer[:end + 1]
+        return line
+
+    @property
+    def in_waiting(self) -> int:
+        if select.select([self.fd], [], [], 0)[0]:
+            self.buffer += os.read(self.fd, 1 << 16)
+        return len(self.buffer)
+
+def _self_test(host_test: str, count: int):
+    """
+    Run random accesses on a host-test binary attached through a pseudo
+    terminal, synchronously and pipelined, checking both against the
+    software simulation
+    """
+    import pty
+    import random
+    import subprocess
+    import time
+    import tty
+
+    master, slave = pty.openpty()
+    tty.setraw(slave)
+    proc = subprocess.Popen([host_test], stdin = slave, stdout = slave)
+    os.close(slave)
+
+    hw = InterpHW(0, serial = _PtySerial(master))
+    sw = Interp(0, hw.generation)
+
+    def check(rng: random.Random, pipelined: bool):
+        results = []
+        with hw.pipeline() if pipelined else nullcontext():
+            for _ in range(count):
+                op = rng.randrange(16)
+                v = rng.getrandbits(32)
+                lane = rng.randrange(2)
+                if op == 0:
+                    v &= 0x007fffff
+                    hw.set_ctrl(lane, v)
+                    sw.set_ctrl(lane, v)
+                elif op == 1:
+                    hw.set_accum(lane, v)
+                    sw.set_accum(lane, v)
+                elif op == 2:
+                    i = rng.randrange(3)
+                    hw.set_base(i, v)
+                    sw.set_base(i, v)
+                elif op == 3:
+                    hw.add(lane, v)
+                    sw.add(lane, v)
+                elif op < 10:
+                    lane = rng.randrange(3)
+                    results.append((hw.pop(lane), sw.pop(lane)))
+                else:
+                    lane = rng.randrange(3)
+                    results.append((hw.peek(lane), sw.peek(lane)))
+
+        for got, expected in results:
+            if isinstance(got, InterpPending):
+                got = got.value
+            if got != expected:
+                raise AssertionError(f"read {got:#x}, expected {expected:#x}")
+
+        # one digest per checkpoint, the full state only on a mismatch
+        digest = hw.digest()
+        if isinstance(digest, InterpPending):
+            digest = digest.value
+        if digest != hw.digest(sw = True):
+            state = hw.diff()
+            raise AssertionError(f"digest differs, state diff: {state}")
+
+    # time the transport only, without the software simulation
+    def throughput(pipelined: bool) -> float:
+        start = time.perf_counter()
+        with hw.pipeline() if pipelined else nullcontext():
+            for _ in range(count):
+                hw._read_reg("peek0")
+        return time.perf_counter() - start
+
+    check(random.Random(1), False)
+    check(random.Random(2), True)
+
+    # window only applies to its block, and an exception of the block is
+    # not replaced by the error of a pipelined command
+    with hw.pipeline(window = 4):
+        if hw.window != 4:
+            raise AssertionError(f"window {hw.window}, expected 4")
+    if hw.window != 256:
+        raise AssertionError(f"window {hw.window} after the block, expected 256")
+    try:
+        with hw.pipeline():
+            hw._send_cmd_ok("bogus")
+            raise KeyError("block")
+    except KeyError:
+        pass
+    if hw._read_reg("accum0") != hw._read_reg("accum0"):
+        raise AssertionError("commands after a failed pipeline block are out of sync")
+
+    # a batch inside a pipeline block runs after the queued commands
+    batch = InterpBatch()
+    batch.read(0, "accum0")
+    with hw.pipeline():
+        hw.set_accum(0, 0x1234)
+        pending = hw._read_reg("accum0")
+        results = hw.run_batch(batch)
+        if results != [0x1234] or pending.value != 0x1234:
+            raise AssertionError(f"batch in a pipeline block read {results}, expected [0x1234]")
+
+    sync = throughput(False)
+    pipelined = throughput(True)
+
+    os.close(master)
+    proc.wait()
+    print(f"sync:      {count} reads in {sync:.3f} s, {count / sync:.0f} ops/s")
+    print(f"pipelined: {count} reads in {pipelined:.3f} s, {count / pipelined:.0f} ops/s")
+
+if __name__ == "__main__":
+    import sys
+    if len(sys.argv) not in (2, 3):
+        print("usage: python -m rp2040_interp.hardware HOST_TEST [COUNT]", file = sys.stderr)
+        sys.exit(2)
+    _self_test(sys.argv[1], int(sys.argv[2]) if len(sys.argv) == 3 else 20000)
@@ -1,9 +1,10 @@
 from __future__ import annotations
-from typing import List
+from typing import Iterable, List
 from dataclasses import dataclass
 from enum import Enum
 from copy import copy, deepcopy
 from random import randint
+from . import native as native_module
 
 ubits = lambda n, b: n & ((1 << b) - 1)
 sbits = lambda n, b: (-1 << (b - 1)) | ubits(n, b) if n & (1 << (b - 1)) else ubits(n, b)
@@ -12,6 +13,27 @@ u16 = lambda n: ubits(n, 16)
 u32 = lambda n: ubits(n, 32)
 s32 = lambda n: sbits(n, 32)
 
+# register names, same order as InterpReg in the test library
+REGS = [
+    "accum0", "accum1", "base0", "base1", "base2", "ctrl0", "ctrl1",
+    "pop0", "pop1", "pop2", "peek0", "peek1", "peek2", "peekraw0", "peekraw1",
+    "add0", "add1", "base01",
+]
+
+# rolling digest of register accesses, same as InterpDigest in the test library
+DIGEST_INIT = 0xcbf29ce484222325
+DIGEST_STATE = 0
+DIGEST_WRITE = 1
+DIGEST_READ = 2
+
+def digest_fold(h: int, op: int, reg: int, v: int) -> int:
+    """
+    Fold one (op, reg, value) word into a digest
+    """
+    h ^= ((op << 8 | reg) << 32) | u32(v)
+    h = (h * 0x9e3779b97f4a7c15) & ((1 << 64) - 1)
+    return h ^ (h >> 29)
+
 class InterpGeneration(Enum):
     """
     Describes which generation of Interpolator peripheral is emulated.
@@ -169,13 +191,17 @@ class Interp:
     _smresult: List[int] # len = 2
     _result: List[int]   # len = 3
 
-    def __init__(self, n: int = 0, generation: InterpGeneration = InterpGeneration.RP2040):
+    def __init__(self, n: int = 0, generation: InterpGeneration = InterpGeneration.RP2040, native: bool | None = None):
         """
-        Construct a software-simulated interpolator peripheral
+        Construct a software-simulated interpolator peripheral.
+        Uses the native backend if it is available, unless native is False.
         """
         assert n in [0, 1], "invalid interpolator index"
+        assert native is not True or native_available(), "native backend not available"
         self.n = n
         self.generation = generation
+        self._native = native_module.InterpNative() if native is not False and native_available() else None
+        self._digest = DIGEST_INIT
         self.accum = [0, 0]
         self.base = [0, 0, 0]
         self.ctrl = [0, 0]
@@ -187,6 +213,7 @@ class Interp:
         """
         Set an accumulator register and update
         """
+        self._digest = digest_fold(self._digest, DIGEST_WRITE, i, v)
         self.accum[i] = v
         self.update()
 
@@ -194,6 +221,7 @@ class Interp:
         """
         Set a base register and update
         """
+        self._digest = digest_fold(self._digest, DIGEST_WRITE, 2 + i, v)
         self.base[i] = v
         self.update()
 
@@ -201,6 +229,7 @@ class Interp:
         """
         Set a ctrl register and update
         """
+        self._digest = digest_fold(self._digest, DIGEST_WRITE, 5 + i, v)
         self.ctrl[i] = v
         self.update()
 
@@ -212,6 +241,7 @@ class Interp:
         self.update()
         v = self._result[i]
         self._writeback()
+        self._digest = digest_fold(self._digest, DIGEST_READ, 7 + i, v)
         return v
 
     def peek(self, i: int) -> int:
@@ -219,6 +249,7 @@ class Interp:
         Read a peek register of the interpolator.
         """
         self.update()
+        self._digest = digest_fold(self._digest, DIGEST_READ, 10 + i, self._result[i])
         return self._result[i]
 
     def peekraw(self, i: int) -> int:
@@ -226,12 +257,14 @@ class Interp:
         Read a raw lane result register of the interpolator.
         """
         self.update()
+        self._digest = digest_fold(self._digest, DIGEST_READ, 13 + i, self._smresult[i])
         return self._smresult[i]
 
     def add(self, i: int, value: int):
         """
         Add to the accumulator of the interpolator.
         """
+        self._digest = digest_fold(self._digest, DIGEST_WRITE, 15 + i, value)
         self.accum[i] += value
         self.update()
 
@@ -239,12 +272,79 @@ class Interp:
         """
         Write to the base01 register of the interpolator.
         """
+        self._digest = digest_fold(self._digest, DIGEST_WRITE, 17, value)
         self._writebase01(value)
 
+    def pop_many(self, i: int, count: int) -> list[int]:
+        """
+        Read a pop register count times.
+        The native backend runs all pops in one call.
+        """
+        if not 0 <= i <= 2:
+            raise IndexError(f"pop register {i} out of range")
+        if self._native is not None:
+            return self._native.pop_many(self, i, count)
+        return [self.pop(i) for _ in range(count)]
+
+    def run_ops(self, ops: Iterable[tuple[str, int | None]]) -> list[int | None]:
+        """
+        Run register accesses given as (register, value) pairs, e.g.
+        ("ctrl0", 0x7c00) writes and ("pop0", None) reads a register.
+        Returns the read values, and None for writes.
+        The native backend runs all accesses in one call.
+        """
+        ops = list(ops)
+        if self._native is None:
+            return [self._run_op(reg, value) for reg, value in ops]
+
+        words = [REGS.index(reg) | (0 if value is None else native_module.OP_WRITE) for reg, value in ops]
+        values = self._native.run_ops(self, words, [u32(value or 0) for reg, value in ops])
+        return [None if value is not None else result for (reg, value), result in zip(ops, values)]
+
+    def _run_op(self, reg: str, value: int | None) -> int | None:
+        i = REGS.index(reg)
+        if value is not None:
+            if reg.startswith("accum"):
+                self.set_accum(i, value)
+            elif reg == "base01":
+                self.base01(value)
+            elif reg.startswith("base"):
+                self.set_base(i - 2, value)
+            elif reg.startswith("ctrl"):
+                self.set_ctrl(i - 5, value)
+            elif reg.startswith("add"):
+                self.add(i - 15, value)
+            return None
+
+        if reg.startswith("pop"):
+            return self.pop(i - 7)
+        elif reg.startswith("peekraw"):
+            return self.peekraw(i - 13)
+        elif reg.startswith("peek"):
+            return self.peek(i - 10)
+        elif reg.startswith("add"):
+            return self.peekraw(i - 15)
+
+        self.update()
+        if reg.startswith("accum"):
+            v = self.accum[i]
+        elif reg == "base01":
+            v = 0
+        elif reg.startswith("base"):
+            v = self.base[i - 2]
+        else:
+            v = self.ctrl[i - 5]
+        self._digest = digest_fold(self._digest, DIGEST_READ, i, v)
+        return v
+
     def update(self):
         """
         Update the interpolator result
         """
+        if self._native is not None:
+            self._native.update(self)
+            return
+
         self._adjustbits()
         ctrl0 = InterpCtrl.from_reg(self.ctrl[0])
         ctrl1 = InterpCtrl.from_reg(self.ctrl[1])
@@ -318,6 +418,10 @@ class Interp:
         self.ctrl[1] = ctrl1.to_reg()
 
     def _writeback(self):
+        if self._native is not None:
+            self._native.writeback(self)
+            return
+
         ctrl0 = InterpCtrl.from_reg(self.ctrl[0])
         ctrl1 = InterpCtrl.from_reg(self.ctrl[1])
 
@@ -327,6 +431,10 @@ class Interp:
         self.update();
 
     def _writebase01(self, v: int):
+        if self._native is not None:
+            self._native.base01(self, v)
+            return
+
         ctrl0 = InterpCtrl.from_reg(self.ctrl[0])
         ctrl1 = InterpCtrl.from_reg(self.ctrl[1])
 
@@ -372,7 +480,26 @@ class Interp:
         """
         Restore the interpolator state
         """
+        for reg, v in enumerate(state.accum + state.base + state.ctrl):
+            self._digest = digest_fold(self._digest, DIGEST_STATE, reg, v)
         self.accum = copy(state.accum)
         self.base = copy(state.base)
         self.ctrl = copy(state.ctrl)
         self.update()
+
+    def digest(self) -> int:
+        """
+        Digest of all register accesses so far and the current state, same
+        as the digest command of the test firmware
+        """
+        state = Interp.save(self)
+        h = self._digest
+        for reg, v in enumerate(state.accum + state.base + state.ctrl + state.peek + state.peekraw):
+            h = digest_fold(h, DIGEST_STATE, reg, v)
+        return h
+
+def native_available() -> bool:
+    """
+    Check if the native backend was built and could be loaded
+    """
+    return native_module.lib is not None
@@ -0,0 +1,131 @@
+from __future__ import annotations
+from pathlib import Path
+from typing import Any, Sequence
+import ctypes
+import os
+import sys
+
+# op word of interp_native_run_ops, see python/native/interp_native.c
+OP_WRITE = 0x100
+
+STATE = ctypes.c_uint32 * 12
+
+def _library_names() -> list[str]:
+    if sys.platform == "win32":
+        return ["rp2040-interp-native.dll", "librp2040-interp-native.dll"]
+    elif sys.platform == "darwin":
+        return ["librp2040-interp-native.dylib", "librp2040-interp-native.so"]
+    else:
+        return ["librp2040-interp-native.so"]
+
+def _load() -> ctypes.CDLL | None:
+    """
+    Load the native backend built with RP2040_INTERP_WITH_PYTHON.
+    RP2040_INTERP_NATIVE names the library in the build tree, or is empty to
+    disable it, otherwise it is looked up next to this file.
+    """
+    path = os.environ.get("RP2040_INTERP_NATIVE")
+    if path == "":
+        return None
+
+    candidates = [Path(path)] if path is not None else [Path(__file__).parent / name for name in _library_names()]
+    for candidate in candidates:
+        if not candidate.exists():
+            continue
+
+        lib = ctypes.CDLL(str(candidate))
+        u32, ptr, size = ctypes.c_uint32, ctypes.c_void_p, ctypes.c_size_t
+        state = ctypes.POINTER(ctypes.c_uint32)
+        lib.interp_native_new.argtypes = [u32]
+        lib.interp_native_new.restype = ptr
+        lib.interp_native_free.argtypes = [ptr]
+        lib.interp_native_free.restype = None
+        for name in ("interp_native_update", "interp_native_writeback"):
+            getattr(lib, name).argtypes = [ptr, u32, u32, state]
+            getattr(lib, name).restype = None
+        lib.interp_native_base01.argtypes = [ptr, u32, u32, state, u32]
+        lib.interp_native_base01.restype = None
+        digest = ctypes.POINTER(ctypes.c_uint64)
+        lib.interp_native_pop_many.argtypes = [ptr, u32, u32, state, u32, state, size, digest]
+        lib.interp_native_pop_many.restype = None
+        lib.interp_native_run_ops.argtypes = [ptr, u32, u32, state, state, state, size, digest]
+        lib.interp_native_run_ops.restype = None
+        return lib
+
+    if path is not None:
+        raise FileNotFoundError(f"RP2040_INTERP_NATIVE: '{path}' not found")
+    return None
+
+lib = _load()
+
+class InterpNative:
+    """
+    Native simulation of one Interp object, using the C library.
+    The Interp object keeps owning the register values, which are copied in
+    and out once per call.
+    """
+    def __init__(self):
+        assert lib is not None, "native backend not available"
+        self.core = lib.interp_native_new(0)
+        if not self.core:
+            raise MemoryError("interp_native_new")
+        self.state = STATE()
+
+    def __del__(self):
+        if lib is not None and getattr(self, "core", None):
+            lib.interp_native_free(self.core)
+            self.core = None
+
+    def __copy__(self) -> InterpNative:
+        # register values live in the Interp object, a copy only needs its
+        # own core
+        return InterpNative()
+
+    def __deepcopy__(self, memo: dict) -> InterpNative:
+        return InterpNative()
+
+    def _load(self, interp: Any) -> tuple[Any, int, int, Any]:
+        accum, base, ctrl = interp.accum, interp.base, interp.ctrl
+        state = self.state
+        state[0], state[1] = accum[0] & 0xffffffff, accum[1] & 0xffffffff
+        state[2], state[3], state[4] = base[0] & 0xffffffff, base[1] & 0xffffffff, base[2] & 0xffffffff
+        state[5], state[6] = ctrl[0] & 0xffffffff, ctrl[1] & 0xffffffff
+        return self.core, interp.n, interp.generation.value, state
+
+    def _store(self, interp: Any):
+        values = self.state[:]
+        interp.accum[:] = values[0:2]
+        interp.base[:] = values[2:5]
+        interp.ctrl[:] = values[5:7]
+        interp._result[:] = values[7:10]
+        interp._smresult[:] = values[10:12]
+
+    def update(self, interp: Any):
+        lib.interp_native_update(*self._load(interp))
+        self._store(interp)
+
+    def writeback(self, interp: Any):
+        lib.interp_native_writeback(*self._load(interp))
+        self._store(interp)
+
+    def base01(self, interp: Any, value: int):
+        lib.interp_native_base01(*self._load(interp), value & 0xffffffff)
+        self._store(interp)
+
+    def pop_many(self, interp: Any, lane: int, count: int) -> list[int]:
+        out = (ctypes.c_uint32 * count)()
+        digest = ctypes.c_uint64(interp._digest)
+        lib.interp_native_pop_many(*self._load(interp), lane, out, count, ctypes.byref(digest))
+        interp._digest = digest.value
+        self._store(interp)
+        return out[:]
+
+    def run_ops(self, interp: Any, ops: Sequence[int], values: Sequence[int]) -> list[int]:
+        count = len(ops)
+        op_array = (ctypes.c_uint32 * count)(*ops)
+        value_array = (ctypes.c_uint32 * count)(*values)
+        digest = ctypes.c_uint64(interp._digest)
+        lib.interp_native_run_ops(*self._load(interp), op_array, value_array, count, ctypes.byref(digest))
+        interp._digest = digest.value
+        self._store(interp)
+        return value_array[:]
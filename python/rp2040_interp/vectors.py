@@ -0,0 +1,165 @@
+from __future__ import annotations
+from dataclasses import dataclass
+from pathlib import Path
+import mmap
+import struct
+import sys
+from .interp import Interp, InterpState, InterpGeneration, REGS
+
+# corpus format, see c/include/interp_vector.h
+VERSION = 1
+HEADER = struct.Struct("<4sHBBQ16x")
+COLUMN_OP = 0
+COLUMN_VALUE = 1
+COLUMN_BEFORE = 2
+COLUMN_AFTER = 14
+STATE_COLUMNS = 12
+COLUMN_COUNT = 26
+
+def _state(values: list[int]) -> InterpState:
+    return InterpState(
+        accum = values[0:2],
+        base = values[2:5],
+        ctrl = values[5:7],
+        peek = values[7:10],
+        peekraw = values[10:12],
+    )
+
+@dataclass
+class InterpVector:
+    """
+    One test vector: restore before on interpolator n, perform one register
+    write or read, and expect the read value and the after state
+    """
+    n: int
+    reg: str
+    write: bool
+    value: int
+    before: InterpState
+    after: InterpState
+
+    def run(self, interp: Interp) -> tuple[int, InterpState]:
+        """
+        Run the vector on an interpolator, returning the value and state
+        """
+        interp.restore(self.before)
+        i = REGS.index(self.reg)
+        value = self.value
+        if self.write:
+            if self.reg.startswith("accum"):
+                interp.accum[i] = value
+            elif self.reg.startswith("base") and self.reg != "base01":
+                interp.base[i - 2] = value
+            elif self.reg.startswith("ctrl"):
+                interp.ctrl[i - 5] = value
+            elif self.reg.startswith("add"):
+                interp.add(i - 15, value)
+            elif self.reg == "base01":
+                interp.base01(value)
+        else:
+            interp.update()
+            if self.reg.startswith("accum"):
+                value = interp.accum[i]
+            elif self.reg == "base01":
+                value = 0
+            elif self.reg.startswith("base"):
+                value = interp.base[i - 2]
+            elif self.reg.startswith("ctrl"):
+                value = interp.ctrl[i - 5]
+            elif self.reg.startswith("pop"):
+                value = interp.pop(i - 7)
+            elif self.reg.startswith("peekraw"):
+                value = interp.peekraw(i - 13)
+            elif self.reg.startswith("peek"):
+                value = interp.peek(i - 10)
+            elif self.reg.startswith("add"):
+                value = interp.peekraw(i - 15)
+
+        return value, interp.save()
+
+    def check(self, interp: Interp) -> bool:
+        """
+        Run the vector on an interpolator, False if value or state differ
+        """
+        value, state = self.run(interp)
+        # (a ^ b) is truthy when the states are identical
+        return value == self.value and bool(state ^ self.after)
+
+class InterpVectorCorpus:
+    """
+    Memory-mapped test vector corpus, columns are read without copying
+    """
+    generation: InterpGeneration
+    columns: list[memoryview]
+
+    _view: memoryview | None = None
+    _data: memoryview | None = None
+
+    def __init__(self, path: Path | str):
+        """
+        Open a corpus file
+        """
+        if sys.byteorder != "little":
+            raise ValueError("corpus files are only supported on little endian hosts")
+
+        with open(path, "rb") as file:
+            self._mmap = mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ)
+
+        try:
+            if len(self._mmap) < HEADER.size:
+                raise ValueError(f"{path}: not a corpus file")
+
+            magic, version, generation, column_count, count = HEADER.unpack_from(self._mmap)
+            if magic != b"IVEC" or version != VERSION or column_count != COLUMN_COUNT:
+                raise ValueError(f"{path}: invalid corpus header or version")
+            if (len(self._mmap) - HEADER.size) // 4 // COLUMN_COUNT < count:
+                raise ValueError(f"{path}: corpus file is truncated")
+
+            self.generation = InterpGeneration(generation)
+            self._count = count
+            self._view = memoryview(self._mmap)
+            self._data = self._view[HEADER.size:HEADER.size + count * COLUMN_COUNT * 4].cast("I")
+            self.columns = [self._data[i * count:(i + 1) * count] for i in range(COLUMN_COUNT)]
+        except:
+            self.close()
+            raise
+
+    def close(self):
+        """
+        Release the columns and unmap the file
+        """
+        for column in getattr(self, "columns", []):
+            column.release()
+        self.columns = []
+        if self._data is not None:
+            self._data.release()
+            self._view.release()
+            self._data = self._view = None
+        self._mmap.close()
+
+    def __enter__(self) -> InterpVectorCorpus:
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def __len__(self) -> int:
+        return self._count
+
+    def __getitem__(self, i: int) -> InterpVector:
+        if i < 0:
+            i += self._count
+        if not 0 <= i < self._count:
+            raise IndexError("vector index out of range")
+
+        op = self.columns[COLUMN_OP][i]
+        before = [self.columns[COLUMN_BEFORE + k][i] for k in range(STATE_COLUMNS)]
+        after = [self.columns[COLUMN_AFTER + k][i] for k in range(STATE_COLUMNS)]
+        return InterpVector(
+            n = op & 1,
+            reg = REGS[(op >> 8) & 0xff],
+            write = bool(op & 2),
+            value = self.columns[COLUMN_VALUE][i],
+            before = _state(before),
+            after = _state(after),
+        )
@@ -0,0 +1,187 @@
+// compile-time checks of the software simulation, nothing here runs
+
+#include <interp.hpp>
+#include <interp-sweep.hpp>
+
+using G = InterpGeneration;
+
+constexpr InterpCtrl full_mask = { .mask_lsb = 0, .mask_msb = 31 };
+
+static_assert(InterpCtrl::from(0x0004fc00).to() == 0x0004fc00);
+static_assert(InterpCtrl{ .mask_msb = 31, .add_raw = 1 }.to() == 0x00047c00);
+static_assert(InterpCtrl::from(0x00208000).blend && InterpCtrl::from(0x00208000).is_signed);
+
+template <size_t N, G Gen = G::RP2040>
+constexpr InterpSW<N, Gen> make(uint32_t ctrl0, uint32_t ctrl1, uint32_t accum0, uint32_t accum1, uint32_t base0, uint32_t base1) {
+    InterpSW<N, Gen> interp;
+    interp.ctrl[0] = ctrl0;
+    interp.ctrl[1] = ctrl1;
+    interp.accum[0] = accum0;
+    interp.accum[1] = accum1;
+    interp.base[0] = base0;
+    interp.base[1] = base1;
+    interp.update();
+    return interp;
+}
+
+// accum0 += base0
+static_assert([] {
+    auto interp = make<0>(full_mask.to(), full_mask.to(), 0x1234, 0, 0x10, 0);
+    return interp.peek(0) == 0x1244 && interp.pop(0) == 0x1244 && interp.peek(0) == 0x1254;
+}());
+
+// shift and mask, unsigned and signed
+static_assert(make<0>(InterpCtrl{ .shift = 4, .mask_msb = 7 }.to(), 0, 0x1234, 0, 0, 0).peekraw(0) == 0x23);
+static_assert(make<0>(InterpCtrl{ .mask_msb = 7, .is_signed = 1 }.to(), 0, 0x80, 0, 0, 0).peekraw(0) == 0xffffff80);
+
+// RP2350 rotates instead of shifting
+static_assert(make<0, G::RP2350>(InterpCtrl{ .shift = 4, .mask_msb = 31 }.to(), 0, 1, 0, 0, 0).peekraw(0) == 0x10000000);
+static_assert(make<0, G::RP2040>(InterpCtrl{ .shift = 4, .mask_msb = 31 }.to(), 0, 1, 0, 0, 0).peekraw(0) == 0);
+
+// blend halfway between base0 and base1
+static_assert([] {
+    auto interp = make<0>(InterpCtrl{ .mask_msb = 31, .blend = 1 }.to(), InterpCtrl{ .mask_msb = 7 }.to(), 0, 0x80, 0, 0x100);
+    return interp.peek(0) == 0x80 && interp.peek(1) == 0x80;
+}());
+
+// clamp to base1, blend is ignored on interpolator 1
+static_assert(make<1>(InterpCtrl{ .mask_msb = 31, .clamp = 1 }.to(), 0, 500, 0, 0, 255).peek(0) == 255);
+static_assert(make<1>(InterpCtrl{ .mask_msb = 31, .blend = 1 }.to(), 0, 500, 0, 0, 255).peek(0) == 500);
+
+// OVERF flags
+static_assert(InterpCtrl::from(make<0>(InterpCtrl{ .mask_msb = 7 }.to(), 0, 0x100, 0, 0, 0).ctrl[0]).overf0);
+static_assert(!InterpCtrl::from(make<0>(InterpCtrl{ .mask_msb = 7 }.to(), 0, 0xff, 0, 0, 0).ctrl[0]).overf);
+
+// advance matches repeated pops
+static_assert([] {
+    auto a = make<0>(InterpCtrl{ .mask_msb = 31, .add_raw = 1 }.to(), InterpCtrl{ .shift = 3, .mask_msb = 9 }.to(), 7, 9, 3, 5);
+    auto b = a;
+    a.advance(100);
+    for (size_t i = 0; i < 100; i++) b.pop(0);
+    return InterpState(a) == InterpState(b) && a.accum[0] == 307;
+}());
+
+// advance with shifted, masked and signed lanes, which are not affine
+static_assert([] {
+    auto a = make<1, G::RP2350>(InterpCtrl{ .shift = 5, .mask_lsb = 2, .mask_msb = 20, .cross_result = 1 }.to(),
+        InterpCtrl{ .shift = 30, .mask_lsb = 0, .mask_msb = 12, .is_signed = 1 }.to(), 0x89abcdef, 0x12345678, 0x1001, 0xfff00007);
+    auto b = a;
+    a.advance(257);
+    for (size_t i = 0; i < 257; i++) b.pop(2);
+    return InterpState(a) == InterpState(b);
+}());
+
+// advance in closed form
+static_assert([] {
+    auto a = make<0>(InterpCtrl{ .mask_msb = 31, .add_raw = 1 }.to(), InterpCtrl{ .mask_msb = 31, .cross_input = 1 }.to(), 7, 9, 3, 5);
+    auto b = a;
+    a.advance(1000);
+    for (size_t i = 0; i < 1000; i++) b.pop(1);
+    return InterpState(a) == InterpState(b) && a.accum[0] == 3007;
+}());
+
+// save and restore
+static_assert([] {
+    auto a = make<0>(InterpCtrl{ .shift = 2, .mask_msb = 15 }.to(), full_mask.to(), 0x1111, 0x2222, 0x33, 0x44);
+    InterpSW<0> b;
+    b = InterpState(a);
+    return InterpState(a) == InterpState(b) && b.pop(2) == a.pop(2);
+}());
+
+// lazy evaluation saves the same states as eager evaluation
+static_assert([] {
+    InterpSW<0, G::RP2040, InterpEvaluation::EAGER> eager;
+    InterpSW<0, G::RP2040, InterpEvaluation::LAZY> lazy;
+    bool same = true;
+    auto step = [&](auto fn) {
+        fn(eager);
+        fn(lazy);
+        same = same && InterpState(eager) == InterpState(lazy);
+    };
+
+    step([](auto& interp) {
+        InterpState state = {};
+        state.base[0] = 1;
+        state.ctrl[0] = state.ctrl[1] = full_mask.to();
+        interp = state;
+    });
+    step([](auto& interp) { interp.pop(0); });
+    step([](auto& interp) { interp.pop(2); });
+    step([](auto& interp) { interp.add(1, 5); });
+    step([](auto& interp) { interp.pop(1); });
+    step([](auto& interp) { interp.base01(0xfff0ffff); });
+    step([](auto& interp) { interp.peek(1); });
+    step([](auto& interp) { interp.ctrl[0] = InterpCtrl{ .shift = 1, .mask_msb = 3 }.to(); interp.update(); });
+    step([](auto& interp) { interp.pop(0); });
+    step([](auto& interp) { interp.advance(7); });
+    return same;
+}());
+
+// save() is const and computes stale lazy results, including OVERF
+static_assert([] {
+    InterpSW<0, G::RP2040, InterpEvaluation::LAZY> lazy;
+    lazy.ctrl[0] = InterpCtrl{ .mask_msb = 7 }.to();
+    lazy.accum[0] = 0x100;
+    lazy.update();
+    const auto& view = lazy;
+    InterpState state = view;
+    return state == InterpState(make<0>(InterpCtrl{ .mask_msb = 7 }.to(), 0, 0x100, 0, 0, 0)) && InterpCtrl::from(state.ctrl[0]).overf0;
+}());
+
+// InterpSWFixed gives the same results
+static_assert([] {
+    constexpr InterpCtrl ctrl0 = { .shift = 4, .mask_msb = 11, .add_raw = 1 };
+    constexpr InterpCtrl ctrl1 = { .shift = 8, .mask_lsb = 4, .mask_msb = 15 };
+
+    auto a = make<0>(ctrl0.to(), ctrl1.to(), 0x12345, 0x6789a, 0x111, 0x222);
+    InterpSWFixed<0, G::RP2040, ctrl0, ctrl1> b;
+    b = InterpState(a);
+
+    uint32_t x[8] = {}, y[8] = {};
+    a.pop_lanes_n(x);
+    b.pop_lanes_n(y);
+    for (size_t i = 0; i < 8; i++) {
+        if (x[i] != y[i]) return false;
+    }
+    return InterpState(a) == InterpState(b);
+}());
+
+// a default constructed InterpSWFixed has valid results, and a read-only ctrl
+static_assert([] {
+    constexpr InterpCtrl ctrl0 = { .mask_msb = 7, .force_msb = 2 };
+    constexpr InterpCtrl ctrl1 = { .mask_msb = 31, .force_msb = 1 };
+
+    auto a = make<0>(ctrl0.to(), ctrl1.to(), 0, 0, 0, 0);
+    InterpSWFixed<0, G::RP2040, ctrl0, ctrl1> b;
+    return b.peek(0) == 0x20000000 && b.read_ctrl(1) == ctrl1.to() && InterpState(a) == InterpState(b);
+}());
+
+// InterpSWFixed register writes update the cached results
+static_assert([] {
+    InterpSWFixed<0, G::RP2040, full_mask, full_mask> interp;
+    interp.write_accum(0, 0x1234);
+    interp.write_base(0, 0x10);
+    interp.write_base(2, 0x1000);
+    return interp.peek(0) == 0x1244 && interp.peekraw(0) == 0x1234 && interp.pop(2) == 0x2234
+        && interp.read_accum(0) == 0x1244 && interp.read_base(2) == 0x1000;
+}());
+static_assert(!InterpBackend<InterpSWFixed<0, G::RP2040, full_mask>>);
+
+// operation counters, all zero unless RP2040_INTERP_WITH_STATS is set
+static_assert([] {
+    auto interp = make<0>(full_mask.to(), full_mask.to(), 0, 0, 1, 1);
+    interp.reset_stats();
+    interp.pop(0);
+    interp.pop(2);
+    interp.update();
+
+    InterpStats stats = interp.stats();
+    if (!InterpStatsCounter::enabled) return stats == InterpStats{};
+    return stats.pops[0] == 1 && stats.pops[2] == 1 && stats.writebacks == 2 && stats.updates == 5 && stats.redundant == 3;
+}());
+
+// CTRL equivalence classes
+static_assert(interp_canonical_ctrl<0>(0x03c0fc00 | 1 << 22, 0x00607c00) == InterpCtrlPair{ { 0x0000fc00, 0x00007c00 } });
+static_assert(interp_canonical_ctrl<1>(0x00003e0, 0) == InterpCtrlPair{ { 0x0000020, 0 } });
+static_assert(interp_canonical_ctrl<0>(0x0024fc00, 0x00047c00) == InterpCtrlPair{ { 0x00207c00, 0x00007c00 } });
+static_assert(interp_canonical_ctrl<1>(0x0047fc00, 0x00047c00) == InterpCtrlPair{ { 0x0043fc00, 0x00047c00 } });
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <string_view>
@@ -7,29 +8,175 @@
 #define INTERP_TYPE Interp
 #endif
 
+// interactive mode reads and answers one line at a time, stream mode reads
+// and writes in large blocks for piping in command files
+static bool stream = false;
+// only print responses that are not "ok" or "data", with their command
+static bool quiet = false;
+
 static char line_buffer[512];
+static char stream_buffer[1 << 20];
+static char output_buffer[1 << 20];
+static size_t stream_begin = 0;
+static size_t stream_end = 0;
+static bool stream_eof = false;
+
+static std::string_view trim_newline(const char* line, size_t length) {
+    if (length > 0 && line[length - 1] == '\n') length--;
+    if (length > 0 && line[length - 1] == '\r') length--;
+    return std::string_view(line, length);
+}
+
+// returns false at the end of the input
+static bool getline_interactive(std::string_view& line) {
+    if (fgets(line_buffer, sizeof line_buffer, stdin) == NULL) return false;
+
+    line = trim_newline(line_buffer, strlen(line_buffer));
+    return true;
+}
 
-std::string_view getline() {
-    size_t length;
+// moves the unread part of the stream buffer to the front and reads more,
+// false if nothing more could be read
+static bool refill_stream() {
+    memmove(stream_buffer, stream_buffer + stream_begin, stream_end - stream_begin);
+    stream_end -= stream_begin;
+    stream_begin = 0;
 
+    size_t n = fread(stream_buffer + stream_end, 1, sizeof stream_buffer - stream_end, stdin);
+    stream_end += n;
+    if (n == 0) stream_eof = true;
+    return n != 0;
+}
+
+// returns false at the end of the input, lines are valid until the next call
+static bool getline_stream(std::string_view& line) {
     while (true) {
-        if (fgets(line_buffer, sizeof line_buffer, stdin) == NULL) {
-            continue;
+        const char* begin = stream_buffer + stream_begin;
+        const char* newline = (const char*)memchr(begin, '\n', stream_end - stream_begin);
+        if (newline != NULL) {
+            size_t length = newline - begin + 1;
+            stream_begin += length;
+            line = trim_newline(begin, length);
+            return true;
+        }
+
+        if (stream_eof || (stream_begin == 0 && stream_end == sizeof stream_buffer)) {
+            // last line without newline, or a line longer than the buffer
+            if (stream_begin == stream_end) return false;
+            line = trim_newline(begin, stream_end - stream_begin);
+            stream_begin = stream_end;
+            return true;
         }
 
-        length = strlen(line_buffer);
-        if (length > 0 && line_buffer[length - 1] == '\n') length--;
-        break;
+        refill_stream();
+    }
+}
+
+static bool getline(std::string_view& line) {
+    return stream ? getline_stream(line) : getline_interactive(line);
+}
+
+static int peek_byte() {
+    if (!stream) {
+        int c = getc(stdin);
+        if (c != EOF) ungetc(c, stdin);
+        return c;
+    }
+
+    if (stream_begin == stream_end && (stream_eof || !refill_stream())) return EOF;
+    return (unsigned char)stream_buffer[stream_begin];
+}
+
+static bool read_bytes(void* data, size_t size) {
+    if (!stream) return fread(data, 1, size, stdin) == size;
+
+    char* out = (char*)data;
+    while (size > 0) {
+        if (stream_begin == stream_end && (stream_eof || !refill_stream())) return false;
+
+        size_t n = std::min(size, stream_end - stream_begin);
+        memcpy(out, stream_buffer + stream_begin, n);
+        stream_begin += n;
+        out += n;
+        size -= n;
     }
+    return true;
+}
+
+static InterpBatchRecord batch_records[InterpBatchHeader::MAX_OPS];
+static uint32_t batch_words[InterpBatchHeader::MAX_WORDS];
 
-    return std::string_view(line_buffer, length);
+// reads one binary batch and writes its response, false at the end of the
+// input
+static bool run_batch(InterpTesterBase& tester) {
+    InterpBatchHeader header;
+    if (!read_bytes(&header, sizeof header)) return false;
+
+    InterpBatchResponseHeader response = { InterpBatchHeader::SYNC, InterpBatchStatus::INVALID, 0, 0 };
+    if (header.count <= InterpBatchHeader::MAX_OPS) {
+        if (!read_bytes(batch_records, header.count * sizeof (InterpBatchRecord))) return false;
+        if (header.valid()) response = tester.run_batch(std::span(batch_records, header.count), batch_words);
+    } else {
+        // skip the records of an oversized batch, so the next frame is in sync
+        for (size_t left = header.count; left > 0;) {
+            size_t n = std::min<size_t>(left, InterpBatchHeader::MAX_OPS);
+            if (!read_bytes(batch_records, n * sizeof (InterpBatchRecord))) return false;
+            left -= n;
+        }
+    }
+
+    fwrite(&response, sizeof response, 1, stdout);
+    fwrite(batch_words, sizeof (uint32_t), response.words, stdout);
+    return true;
+}
+
+static bool is_failure(std::string_view response) {
+    return !response.starts_with("ok") && !response.starts_with("data") && !response.starts_with("generation");
 }
 
-int main() {
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stream") == 0) {
+            stream = true;
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else {
+            fprintf(stderr, "usage: %s [--stream] [--quiet]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (stream) setvbuf(stdout, output_buffer, _IOFBF, sizeof output_buffer);
+
     InterpTester<INTERP_TYPE> tester;
+    size_t line_number = 0;
+    size_t failures = 0;
+
+    std::string_view command;
     while (true) {
-        std::string_view command = getline();
+        // binary batches are answered even in quiet mode
+        if (peek_byte() == InterpBatchHeader::SYNC) {
+            if (!run_batch(tester)) break;
+            if (!stream) fflush(stdout);
+            continue;
+        }
+
+        if (!getline(command)) break;
+        line_number++;
         std::string_view response = tester.parse_command(command);
-        puts(response.data());
+
+        if (quiet) {
+            if (!is_failure(response)) continue;
+            failures++;
+            printf("%zu: %.*s: %.*s\n", line_number, (int)command.size(), command.data(), (int)response.size(), response.data());
+        } else {
+            fwrite(response.data(), 1, response.size(), stdout);
+            putchar('\n');
+        }
+
+        if (!stream) fflush(stdout);
     }
+
+    fflush(stdout);
+    return failures ? 1 : 0;
 }
@@ -0,0 +1,383 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include <interp.hpp>
+#include <interp-sio.hpp>
+
+#if RP2040_INTERP_WITH_C
+#include <interp.h>
+#endif
+
+constexpr size_t BATCH = 4096;
+constexpr double NOISE_NS = 0.5;
+
+static size_t repeat = 50;
+static uint32_t buffer[BATCH];
+static volatile uint32_t sink;
+
+struct Mode {
+    const char* name;
+    size_t index;
+    InterpGeneration generation;
+    InterpCtrl ctrl0;
+    InterpCtrl ctrl1;
+};
+
+constexpr Mode modes[] = {
+    // accum += base, results are the new accumulators
+    { "plain", 0, InterpGeneration::RP2040, { .mask_msb = 31 }, { .mask_msb = 31 } },
+    // texture address: accum += base, full result combines bitfields of both
+    { "add_raw", 0, InterpGeneration::RP2040, { .shift = 16, .mask_msb = 7, .add_raw = 1 }, { .shift = 8, .mask_lsb = 8, .mask_msb = 15, .add_raw = 1 } },
+    { "cross", 0, InterpGeneration::RP2040, { .shift = 1, .mask_msb = 30, .cross_input = 1, .cross_result = 1 }, { .mask_msb = 31, .cross_input = 1 } },
+    { "signed", 0, InterpGeneration::RP2040, { .shift = 4, .mask_msb = 11, .is_signed = 1 }, { .mask_lsb = 2, .mask_msb = 15, .is_signed = 1 } },
+    { "blend", 0, InterpGeneration::RP2040, { .mask_msb = 31, .blend = 1 }, { .mask_msb = 7, .add_raw = 1 } },
+    { "clamp", 1, InterpGeneration::RP2040, { .shift = 2, .mask_msb = 31, .is_signed = 1, .clamp = 1 }, { .mask_msb = 31 } },
+    { "rp2350", 0, InterpGeneration::RP2350, { .shift = 4, .mask_msb = 31 }, { .shift = 28, .mask_msb = 31 } },
+};
+
+struct Result {
+    std::string backend;
+    std::string mode;
+    std::string op;
+    double ns;
+};
+
+static std::vector<Result> results;
+
+// makes the compiler assume that value is read and all memory is changed, so
+// no work on value is hoisted out of or merged across loop iterations
+template <typename T>
+static inline void escape(T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// runs fn(buffer) repeat times and returns the fastest time per element
+template <typename Fn>
+double measure(Fn fn) {
+    double best = 1e30;
+    for (size_t r = 0; r < repeat; r++) {
+        auto start = std::chrono::steady_clock::now();
+        fn(std::span<uint32_t>(buffer));
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / BATCH);
+        sink = buffer[BATCH - 1];
+    }
+    return best;
+}
+
+static InterpState initial_state(const Mode& mode) {
+    InterpState state = {};
+    state.accum[0] = 0x00012345;
+    state.accum[1] = 0x00054321;
+    state.base[0] = 0x00000123;
+    state.base[1] = 0x00004567;
+    state.base[2] = 0x20000000;
+    state.ctrl[0] = mode.ctrl0.to();
+    state.ctrl[1] = mode.ctrl1.to();
+    return state;
+}
+
+// CTRL_LANE0 value that differs from mode.ctrl0 in a mode bit
+static uint32_t other_ctrl0(const Mode& mode) {
+    return mode.ctrl0.to() ^ (1U << 15);
+}
+
+template <typename Interp>
+void bench_backend(const char* backend, const Mode& mode) {
+    static const char* peek_ops[] = { "peek0", "peek1", "peek2" };
+    static const char* pop_ops[] = { "pop0", "pop1", "pop2" };
+
+    auto add = [&](const char* op, double ns) { results.push_back({ backend, mode.name, op, ns }); };
+    const InterpState state = initial_state(mode);
+    InterpState saved = state;
+    Interp interp;
+    interp = state;
+
+    for (size_t i = 0; i < 3; i++) {
+        add(peek_ops[i], measure([&](std::span<uint32_t> out) { for (uint32_t& v : out) { v = interp.peek(i); escape(interp); } }));
+    }
+    for (size_t i = 0; i < 3; i++) {
+        interp = state;
+        add(pop_ops[i], measure([&](std::span<uint32_t> out) { for (uint32_t& v : out) { v = interp.pop(i); escape(interp); } }));
+    }
+
+    interp = state;
+    add("pop_n", measure([&](std::span<uint32_t> out) { interp.pop_n(2, out); escape(interp); }));
+
+    interp = state;
+    add("add", measure([&](std::span<uint32_t> out) {
+        for (size_t k = 0; k < out.size(); k++) {
+            interp.add(k & 1, k);
+            out[k] = interp.peek(2);
+            escape(interp);
+        }
+    }));
+
+    add("base01", measure([&](std::span<uint32_t> out) {
+        for (size_t k = 0; k < out.size(); k++) {
+            interp.base01(k * 0x00010001);
+            out[k] = interp.peek(2);
+            escape(interp);
+        }
+    }));
+
+    add("save", measure([&](std::span<uint32_t> out) {
+        for (uint32_t& v : out) {
+            interp.save(saved);
+            v = saved.peek[0];
+            escape(interp);
+        }
+    }));
+
+    add("restore", measure([&](std::span<uint32_t> out) {
+        for (uint32_t& v : out) {
+            interp.restore(state);
+            v = interp.peek(0);
+            escape(interp);
+        }
+    }));
+
+    // InterpSWFixed has no ctrl to write
+    if constexpr (InterpBackend<Interp>) {
+        interp = state;
+        add("ctrl", measure([&](std::span<uint32_t> out) {
+            for (size_t k = 0; k < out.size(); k++) {
+                interp.ctrl[0] = (k & 1) ? mode.ctrl0.to() : other_ctrl0(mode);
+                out[k] = interp.peek(0);
+                escape(interp);
+            }
+        }));
+    }
+}
+
+#if RP2040_INTERP_WITH_C
+void bench_c_api(const Mode& mode) {
+    static const char* peek_ops[] = { "peek0", "peek1", "peek2" };
+    static const char* pop_ops[] = { "pop0", "pop1", "pop2" };
+
+    auto add = [&](const char* op, double ns) { results.push_back({ "C", mode.name, op, ns }); };
+    InterpState initial = initial_state(mode);
+    interp_sw_save_t state;
+    memcpy(&state, &initial, sizeof state);
+
+    interp_sw_t interp = {};
+    interp.index = mode.index;
+    interp.generation = mode.generation == InterpGeneration::RP2040 ? INTERP_SW_GENERATION_RP2040 : INTERP_SW_GENERATION_RP2350;
+    interp.evaluation = INTERP_SW_EVALUATION_EAGER;
+    interp_sw_restore(&interp, &state);
+
+    auto peek = [&](size_t i) { return i == 2 ? interp_sw_peek_full_result(&interp) : interp_sw_peek_lane_result(&interp, i); };
+    auto pop = [&](size_t i) { return i == 2 ? interp_sw_pop_full_result(&interp) : interp_sw_pop_lane_result(&interp, i); };
+
+    for (size_t i = 0; i < 3; i++) {
+        add(peek_ops[i], measure([&](std::span<uint32_t> out) { for (uint32_t& v : out) { v = peek(i); escape(interp); } }));
+    }
+    for (size_t i = 0; i < 3; i++) {
+        interp_sw_restore(&interp, &state);
+        add(pop_ops[i], measure([&](std::span<uint32_t> out) { for (uint32_t& v : out) { v = pop(i); escape(interp); } }));
+    }
+
+    interp_sw_restore(&interp, &state);
+    add("pop_n", measure([&](std::span<uint32_t> out) { interp_sw_pop_full_results(&interp, out.data(), out.size()); escape(interp); }));
+
+    interp_sw_restore(&interp, &state);
+    add("add", measure([&](std::span<uint32_t> out) {
+        for (size_t k = 0; k < out.size(); k++) {
+            interp_sw_add_accumulator(&interp, k & 1, k);
+            out[k] = peek(2);
+            escape(interp);
+        }
+    }));
+
+    add("base01", measure([&](std::span<uint32_t> out) {
+        for (size_t k = 0; k < out.size(); k++) {
+            interp_sw_set_base_both(&interp, k * 0x00010001);
+            out[k] = peek(2);
+            escape(interp);
+        }
+    }));
+
+    interp_sw_save_t saved;
+    add("save", measure([&](std::span<uint32_t> out) {
+        for (uint32_t& v : out) {
+            interp_sw_save(&interp, &saved);
+            v = saved.peek[0];
+            escape(interp);
+        }
+    }));
+
+    add("restore", measure([&](std::span<uint32_t> out) {
+        for (uint32_t& v : out) {
+            interp_sw_restore(&interp, &state);
+            v = peek(0);
+            escape(interp);
+        }
+    }));
+
+    interp_sw_restore(&interp, &state);
+    add("ctrl", measure([&](std::span<uint32_t> out) {
+        for (size_t k = 0; k < out.size(); k++) {
+            interp.ctrl[0] = (k & 1) ? mode.ctrl0.to() : other_ctrl0(mode);
+            out[k] = peek(0);
+            escape(interp);
+        }
+    }));
+}
+#endif
+
+// pops from one interpolator per core, both cores on one thread or on two
+// threads in parallel, ns are per pop
+template <size_t N, InterpGeneration G>
+void bench_sio(const Mode& mode) {
+    constexpr size_t PASSES = 64;
+    alignas(INTERP_CACHE_LINE_SIZE) static uint32_t core_buffer[InterpSIO<G>::CORE_COUNT][BATCH];
+
+    InterpSIO<G> sio;
+    for (auto& core : sio.core) core.template interp<N>() = initial_state(mode);
+
+    auto work = [&](typename InterpSIO<G>::Core& core) {
+        size_t num = &core - sio.core;
+        for (size_t pass = 0; pass < PASSES; pass++) {
+            core.template interp<N>().pop_n(2, core_buffer[num]);
+            escape(core);
+        }
+    };
+
+    auto time = [&](auto fn) {
+        double best = 1e30;
+        for (size_t r = 0; r < std::max<size_t>(repeat / 10, 1); r++) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / (PASSES * BATCH * InterpSIO<G>::CORE_COUNT));
+            sink = core_buffer[0][BATCH - 1] ^ core_buffer[1][BATCH - 1];
+        }
+        return best;
+    };
+
+    results.push_back({ "InterpSIO", mode.name, "pop_n_1thread", time([&] { work(sio.core[0]); work(sio.core[1]); }) });
+    results.push_back({ "InterpSIO", mode.name, "pop_n_2thread", time([&] { sio.run(work, work); }) });
+}
+
+template <size_t I>
+void bench_mode() {
+    constexpr Mode mode = modes[I];
+    constexpr size_t N = mode.index;
+    constexpr InterpGeneration G = mode.generation;
+
+    bench_backend<InterpSW<N, G>>("InterpSW", mode);
+    bench_backend<InterpSW<N, G, InterpEvaluation::LAZY>>("InterpSW-lazy", mode);
+    bench_backend<InterpSWFixed<N, G, mode.ctrl0, mode.ctrl1>>("InterpSWFixed", mode);
+    bench_sio<N, G>(mode);
+#if RP2040_INTERP_WITH_C
+    bench_backend<InterpSWC<N, G>>("InterpSWC", mode);
+    bench_c_api(mode);
+#endif
+}
+
+template <size_t... I>
+void bench_modes(std::index_sequence<I...>) {
+    (bench_mode<I>(), ...);
+}
+
+static void print_text() {
+    for (const Result& r : results) {
+        printf("%-14s %-8s %-8s %8.2f ns\n", r.backend.c_str(), r.mode.c_str(), r.op.c_str(), r.ns);
+    }
+}
+
+static void print_json() {
+    printf("{\n  \"unit\": \"ns/op\",\n  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        printf("    { \"backend\": \"%s\", \"mode\": \"%s\", \"op\": \"%s\", \"ns\": %.3f }%s\n",
+            r.backend.c_str(), r.mode.c_str(), r.op.c_str(), r.ns, i + 1 < results.size() ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+// reads the results of a previous --json run, returns false if unreadable
+static bool read_baseline(const char* path, std::vector<Result>& baseline) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return false;
+
+    char line[512];
+    while (fgets(line, sizeof line, file) != NULL) {
+        char backend[64], mode[64], op[64];
+        double ns;
+        if (sscanf(line, " { \"backend\": \"%63[^\"]\", \"mode\": \"%63[^\"]\", \"op\": \"%63[^\"]\", \"ns\": %lf", backend, mode, op, &ns) == 4) {
+            baseline.push_back({ backend, mode, op, ns });
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+// reports results more than threshold percent slower than the baseline,
+// ignoring differences below the timer noise, returns the number of regressions
+static size_t compare_baseline(const std::vector<Result>& baseline, double threshold) {
+    size_t regressions = 0;
+    for (const Result& r : results) {
+        auto it = std::find_if(baseline.begin(), baseline.end(), [&](const Result& b) {
+            return b.backend == r.backend && b.mode == r.mode && b.op == r.op;
+        });
+        if (it == baseline.end()) continue;
+
+        double change = (r.ns / it->ns - 1) * 100;
+        if (change > threshold && r.ns - it->ns > NOISE_NS) {
+            fprintf(stderr, "regression: %s %s %s %.2f ns -> %.2f ns (%+.0f%%)\n",
+                r.backend.c_str(), r.mode.c_str(), r.op.c_str(), it->ns, r.ns, change);
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [--json] [--repeat N] [--baseline FILE] [--threshold PERCENT]\n", name);
+}
+
+int main(int argc, char** argv) {
+    bool json = false;
+    const char* baseline_path = NULL;
+    double threshold = 10;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Result> baseline;
+    if (baseline_path != NULL && !read_baseline(baseline_path, baseline)) {
+        fprintf(stderr, "cannot read baseline %s\n", baseline_path);
+        return 2;
+    }
+
+    bench_modes(std::make_index_sequence<std::size(modes)>());
+
+    if (json) {
+        print_json();
+    } else {
+        print_text();
+    }
+
+    if (baseline_path != NULL && compare_baseline(baseline, threshold) > 0) {
+        return 1;
+    }
+}
@@ -0,0 +1,645 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <interp-test.hpp>
+#include <interp-sw-batch.hpp>
+#include <interp-sio.hpp>
+
+// host version of the pico-auto-test loop: random state writes, register
+// writes and register reads on InterpSW and InterpSWC, comparing the value
+// read and the full state after every action. With --check, the actions run
+// through InterpDualTester<InterpSW, InterpSWC> with that checking policy
+// instead, on the default generation. With --batch, the batched simulations
+// are compared with single pops instead, and with --sio, two InterpSIO popping
+// on both cores at once are compared with InterpSW.
+
+static int usage(const char* name) {
+    fprintf(stderr, "usage: %s [--threads N] [--seed SEED] [--runs N] [--length N] [--generation rp2040|rp2350|both] [--check every|INTERVAL|digest:INTERVAL|reads|end]\n", name);
+    fprintf(stderr, "       %s --replay RUN_SEED [--length N] [--generation rp2040|rp2350|both]\n", name);
+    fprintf(stderr, "       %s --batch RUNS [--seed SEED] [--length N] [--generation rp2040|rp2350|both]\n", name);
+    fprintf(stderr, "       %s --sio RUNS [--seed SEED] [--length N] [--generation rp2040|rp2350|both]\n", name);
+    return 2;
+}
+
+constexpr static const char* reg_names[] = {
+    "accum0", "accum1", "base0", "base1", "base2", "ctrl0", "ctrl1",
+    "pop0", "pop1", "pop2", "peek0", "peek1", "peek2", "peekraw0", "peekraw1",
+    "add0", "add1", "base01",
+};
+
+enum struct ActionKind : uint8_t {
+    STATE,
+    WRITE,
+    READ,
+};
+
+struct Action {
+    ActionKind kind;
+    interp_num_t n;
+    InterpReg reg;
+    uint32_t value;
+    InterpState state;
+};
+
+// seed of run i, so every run can be reproduced on its own with --replay
+static uint64_t run_seed(uint64_t seed, uint64_t i) {
+    uint64_t z = seed + (i + 1) * 0x9e3779b97f4a7c15;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+static InterpState random_state(std::mt19937& rng) {
+    InterpState s;
+    for (uint32_t& v : s.accum) v = rng();
+    for (uint32_t& v : s.base) v = rng();
+    for (uint32_t& v : s.ctrl) v = rng();
+    for (uint32_t& v : s.peek) v = rng();
+    for (uint32_t& v : s.peekraw) v = rng();
+    return s;
+}
+
+// same scheme as pico-auto-test: an initial state on both interpolators,
+// followed by random actions
+static void random_actions(uint64_t seed, size_t length, std::vector<Action>& actions) {
+    std::mt19937 rng(seed ^ (seed >> 32));
+    actions.clear();
+
+    InterpState initial = random_state(rng);
+    actions.push_back({ ActionKind::STATE, 0, {}, 0, initial });
+    actions.push_back({ ActionKind::STATE, 1, {}, 0, initial });
+    while (actions.size() < length) {
+        Action action = { (ActionKind)(rng() % 3), (interp_num_t)(rng() % 2), {}, 0, {} };
+        if (action.kind == ActionKind::STATE) {
+            action.state = random_state(rng);
+        } else {
+            action.reg = InterpReg(rng() % (int(InterpReg::BASE01) + 1));
+            if (action.kind == ActionKind::WRITE) action.value = rng();
+        }
+        actions.push_back(action);
+    }
+}
+
+template <InterpGeneration G>
+struct Pair {
+    InterpSW<0, G> sw0;
+    InterpSW<1, G> sw1;
+    InterpSWC<0, G> swc0;
+    InterpSWC<1, G> swc1;
+
+    template <typename Fn>
+    bool apply(interp_num_t n, Fn&& fn) {
+        uint32_t sw_value = 0, swc_value = 0;
+        InterpState sw_state, swc_state;
+        if (n == 0) {
+            fn(sw0, sw_value);
+            fn(swc0, swc_value);
+            sw0.update();
+            sw_state = sw0;
+            swc0.update();
+            swc_state = swc0;
+        } else {
+            fn(sw1, sw_value);
+            fn(swc1, swc_value);
+            sw1.update();
+            sw_state = sw1;
+            swc1.update();
+            swc_state = swc1;
+        }
+        return sw_value == swc_value && sw_state == swc_state;
+    }
+};
+
+// index of the first action where InterpSW and InterpSWC differ, or
+// actions.size()
+template <InterpGeneration G>
+static size_t diverges(const std::vector<Action>& actions) {
+    Pair<G> pair;
+    for (size_t i = 0; i < actions.size(); i++) {
+        const Action& action = actions[i];
+        bool ok = pair.apply(action.n, [&](auto& intrp, uint32_t& value) {
+            // apply() updates after every action, so reads never need to
+            bool dirty = false;
+            switch (action.kind) {
+                case ActionKind::STATE: intrp = action.state; break;
+                case ActionKind::WRITE: interp_write_reg(intrp, dirty, action.reg, action.value); break;
+                case ActionKind::READ: interp_read_reg(intrp, dirty, action.reg, value); break;
+            }
+        });
+        if (!ok) return i;
+    }
+    return actions.size();
+}
+
+static size_t diverges(InterpGeneration generation, const std::vector<Action>& actions) {
+    if (generation == InterpGeneration::RP2040) {
+        return diverges<InterpGeneration::RP2040>(actions);
+    } else {
+        return diverges<InterpGeneration::RP2350>(actions);
+    }
+}
+
+// drops actions as long as the sequence still diverges
+static void minimize(InterpGeneration generation, std::vector<Action>& actions) {
+    actions.resize(diverges(generation, actions) + 1);
+
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (size_t i = actions.size() - 1; i-- > 0;) {
+            std::vector<Action> candidate = actions;
+            candidate.erase(candidate.begin() + i);
+
+            size_t index = diverges(generation, candidate);
+            if (index < candidate.size()) {
+                candidate.resize(index + 1);
+                actions = std::move(candidate);
+                progress = true;
+            }
+        }
+    }
+}
+
+// prints actions as text protocol commands
+static void print_actions(const std::vector<Action>& actions) {
+    for (const Action& action : actions) {
+        switch (action.kind) {
+            case ActionKind::STATE: {
+                const InterpState& s = action.state;
+                printf("state %u 0x%x 0x%x 0x%x 0x%x 0x%x 0x%x 0x%x\n", action.n,
+                    s.accum[0], s.accum[1], s.base[0], s.base[1], s.base[2], s.ctrl[0], s.ctrl[1]);
+                break;
+            }
+            case ActionKind::WRITE: printf("write %u %s 0x%x\n", action.n, reg_names[(size_t)action.reg], action.value); break;
+            case ActionKind::READ: printf("read %u %s\n", action.n, reg_names[(size_t)action.reg]); break;
+        }
+        printf("dump %u\n", action.n);
+    }
+}
+
+static const char* generation_name(InterpGeneration generation) {
+    return generation == InterpGeneration::RP2040 ? "RP2040" : "RP2350";
+}
+
+struct Options {
+    size_t threads = std::thread::hardware_concurrency();
+    uint64_t seed = 1;
+    uint64_t runs = 100000;
+    size_t length = 256;
+    std::vector<InterpGeneration> generations = { InterpGeneration::RP2040, InterpGeneration::RP2350 };
+    bool dual = false;
+    InterpCheckPolicy policy = InterpCheckPolicy::EVERY_OP;
+    uint64_t interval = 64;
+    uint64_t batch_runs = 0;
+    uint64_t sio_runs = 0;
+};
+
+// runs actions on InterpDualTester, returning the number of accesses run
+// when a mismatch was detected, or actions.size() + 1 if none was
+static size_t dual_diverges(const Options& options, const std::vector<Action>& actions) {
+    InterpDualTester<InterpSW, InterpSWC> tester;
+    tester.policy = options.policy;
+    tester.interval = options.interval;
+
+    try {
+        for (const Action& action : actions) {
+            uint32_t value;
+            switch (action.kind) {
+                case ActionKind::STATE: tester.write_state(action.n, action.state); break;
+                case ActionKind::WRITE: tester.write_reg(action.n, action.reg, action.value); break;
+                case ActionKind::READ: tester.read_reg(action.n, action.reg, value); break;
+            }
+        }
+        tester.finish();
+    } catch (const InterpDualTestFailure& e) {
+        return e.accesses;
+    }
+    return actions.size() + 1;
+}
+
+struct Failure {
+    uint64_t run;
+    InterpGeneration generation;
+};
+
+static int fuzz(const Options& options) {
+    std::atomic<uint64_t> next_run = 0;
+    std::atomic<uint64_t> failed_run = UINT64_MAX;
+    std::atomic<uint64_t> actions_done = 0;
+    std::vector<Failure> failures(options.threads, { UINT64_MAX, {} });
+
+    // runs are handed out in order, so the first failure reported is the
+    // lowest failing run once all workers stopped
+    auto worker = [&](size_t t) {
+        std::vector<Action> actions;
+        uint64_t done = 0;
+        for (uint64_t i; (i = next_run++) < options.runs && i < failed_run;) {
+            random_actions(run_seed(options.seed, i), options.length, actions);
+            for (InterpGeneration generation : options.generations) {
+                done += actions.size();
+                bool mismatch = options.dual ? dual_diverges(options, actions) <= actions.size() : diverges(generation, actions) < actions.size();
+                if (mismatch) {
+                    failures[t] = { i, generation };
+                    uint64_t prev = failed_run;
+                    while (i < prev && !failed_run.compare_exchange_weak(prev, i)) {}
+                    break;
+                }
+            }
+            if (failures[t].run != UINT64_MAX) break;
+        }
+        actions_done += done;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < options.threads; t++) workers.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& thread : workers) thread.join();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    uint64_t runs = std::min<uint64_t>(next_run, options.runs);
+    printf("%llu runs, %llu actions on %zu threads in %.3f s, %.2f Mactions/s\n",
+        (unsigned long long)runs, (unsigned long long)actions_done.load(), options.threads, seconds, actions_done / seconds / 1e6);
+
+    Failure failure = *std::min_element(failures.begin(), failures.end(), [](const Failure& a, const Failure& b) { return a.run < b.run; });
+    if (failure.run == UINT64_MAX) return 0;
+
+    uint64_t seed = run_seed(options.seed, failure.run);
+    std::vector<Action> actions;
+    random_actions(seed, options.length, actions);
+    minimize(failure.generation, actions);
+
+    printf("mismatch on %s in run %llu, reproduce with --replay 0x%016llx --length %zu\n",
+        generation_name(failure.generation), (unsigned long long)failure.run, (unsigned long long)seed, options.length);
+    printf("minimal sequence (%zu actions):\n", actions.size());
+    print_actions(actions);
+    return 1;
+}
+
+static const char* isa_name(InterpBatchIsa isa) {
+    switch (isa) {
+        case InterpBatchIsa::SCALAR: return "scalar";
+        case InterpBatchIsa::SSE2: return "sse2";
+        case InterpBatchIsa::AVX2: return "avx2";
+    }
+    return "?";
+}
+
+// random CTRL/accum/base on count instances of an InterpSWBatch and of
+// InterpSW, then random pops, peeks and adds on all of them, comparing the
+// values read and every state after each step. The batch is set up in a
+// temporary that is copied or moved from. Returns the failing step or
+// length.
+template <size_t N, InterpGeneration G, size_t Width>
+static size_t batch_diverges(uint64_t seed, size_t length, InterpBatchIsa isa) {
+    std::mt19937 rng(seed ^ (seed >> 32));
+    size_t count = rng() % (3 * Width + 2);
+
+    std::vector<InterpSW<N, G>> sw(count);
+    InterpSWBatch<N, G, Width> batch = [&] {
+        InterpSWBatch<N, G, Width> setup(count, isa);
+        for (size_t k = 0; k < count; k++) {
+            InterpState s = random_state(rng);
+            sw[k] = s;
+            sw[k].update();
+            setup.restore(k, s);
+        }
+        setup.update();
+        return rng() % 2 ? InterpSWBatch<N, G, Width>(setup) : InterpSWBatch<N, G, Width>(std::move(setup));
+    }();
+
+    std::vector<uint32_t> values(count), expected(count);
+    for (size_t step = 0; step < length; step++) {
+        size_t op = rng() % 4;
+        size_t i = op == 2 || op == 3 ? rng() % 2 : rng() % 3;
+        switch (op) {
+            case 0:
+                batch.pop(i, values);
+                for (size_t k = 0; k < count; k++) expected[k] = sw[k].pop(i);
+                break;
+            case 1:
+                batch.peek(i, values);
+                for (size_t k = 0; k < count; k++) expected[k] = sw[k].peek(i);
+                break;
+            case 2:
+                batch.peekraw(i, values);
+                for (size_t k = 0; k < count; k++) expected[k] = sw[k].peekraw(i);
+                break;
+            case 3:
+                for (size_t k = 0; k < count; k++) {
+                    values[k] = expected[k] = rng();
+                    sw[k].add(i, values[k]);
+                }
+                batch.add(i, values);
+                batch.update();
+                break;
+        }
+        if (values != expected) return step;
+
+        for (size_t k = 0; k < count; k++) {
+            InterpState state;
+            batch.save(k, state);
+            if (state != InterpState(sw[k])) return step;
+        }
+    }
+    return length;
+}
+
+template <size_t N, InterpGeneration G, size_t Width>
+static bool check_batch(const Options& options, InterpBatchIsa isa) {
+    for (uint64_t i = 0; i < options.batch_runs; i++) {
+        uint64_t seed = run_seed(options.seed, i);
+        size_t step = batch_diverges<N, G, Width>(seed, options.length, isa);
+        if (step < options.length) {
+            printf("InterpSWBatch<%zu, %s, %zu> (%s) differs from InterpSW at step %zu of run seed 0x%016llx\n",
+                N, generation_name(G), Width, isa_name(isa), step, (unsigned long long)seed);
+            return false;
+        }
+    }
+    return true;
+}
+
+template <InterpGeneration G>
+static bool check_batches(const Options& options) {
+    bool ok = true;
+    InterpBatchIsa best = InterpSWBatch<0, G>::detect_isa();
+    for (InterpBatchIsa isa : { InterpBatchIsa::SCALAR, InterpBatchIsa::SSE2, InterpBatchIsa::AVX2 }) {
+        if (isa > best) break;
+        ok &= check_batch<0, G, 8>(options, isa);
+        ok &= check_batch<1, G, 8>(options, isa);
+        ok &= check_batch<0, G, 16>(options, isa);
+        ok &= check_batch<1, G, 16>(options, isa);
+    }
+    return ok;
+}
+
+// random states on two copies of a C interpolator, then random calls of the
+// batch pop functions on one and the single calls they stand for on the
+// other, comparing the values popped and the states after each step.
+// Returns the failing step or length.
+static size_t c_batch_diverges(uint64_t seed, size_t length, uint32_t generation) {
+    std::mt19937 rng(seed ^ (seed >> 32));
+    std::vector<uint32_t> vals, out, expected;
+
+    for (size_t step = 0; step < length; step++) {
+        InterpState initial = random_state(rng);
+        interp_sw_save_t state;
+        memcpy(&state, &initial, sizeof state);
+
+        interp_sw_t batch = {};
+        batch.index = rng() % 2;
+        batch.generation = generation;
+        batch.evaluation = rng() % 2 ? INTERP_SW_EVALUATION_LAZY : INTERP_SW_EVALUATION_EAGER;
+        interp_sw_restore(&batch, &state);
+        interp_sw_t single = batch;
+
+        size_t n = rng() % 40;
+        uint32_t pop_lane = rng() % 2;
+        uint32_t add_lane = rng() % 2;
+        vals.resize(n);
+        for (uint32_t& v : vals) v = rng();
+        out.assign(2 * n, 0);
+        expected.assign(2 * n, 0);
+
+        switch (rng() % 4) {
+            case 0:
+                interp_sw_pop_lane_results(&batch, pop_lane, out.data(), n);
+                for (size_t k = 0; k < n; k++) expected[k] = interp_sw_pop_lane_result(&single, pop_lane);
+                break;
+            case 1:
+                interp_sw_pop_full_results(&batch, out.data(), n);
+                for (size_t k = 0; k < n; k++) expected[k] = interp_sw_pop_full_result(&single);
+                break;
+            case 2:
+                interp_sw_pop_both_lane_results(&batch, out.data(), n);
+                for (size_t k = 0; k < n; k++) {
+                    expected[2 * k] = interp_sw_peek_lane_result(&single, 0);
+                    expected[2 * k + 1] = interp_sw_pop_lane_result(&single, 1);
+                }
+                break;
+            case 3:
+                interp_sw_add_pop_lane_results(&batch, add_lane, vals.data(), pop_lane, out.data(), n);
+                for (size_t k = 0; k < n; k++) {
+                    interp_sw_add_accumulator(&single, add_lane, vals[k]);
+                    expected[k] = interp_sw_pop_lane_result(&single, pop_lane);
+                }
+                break;
+        }
+        if (out != expected) return step;
+
+        interp_sw_save_t batch_state, single_state;
+        interp_sw_save(&batch, &batch_state);
+        interp_sw_save(&single, &single_state);
+        if (memcmp(&batch_state, &single_state, sizeof batch_state) != 0) return step;
+    }
+    return length;
+}
+
+static bool check_c_batch(const Options& options, InterpGeneration generation) {
+    uint32_t c_generation = generation == InterpGeneration::RP2040 ? INTERP_SW_GENERATION_RP2040 : INTERP_SW_GENERATION_RP2350;
+    for (uint64_t i = 0; i < options.batch_runs; i++) {
+        uint64_t seed = run_seed(options.seed, i);
+        size_t step = c_batch_diverges(seed, options.length, c_generation);
+        if (step < options.length) {
+            printf("C batch pops on %s differ from single pops at step %zu of run seed 0x%016llx\n",
+                generation_name(generation), step, (unsigned long long)seed);
+            return false;
+        }
+    }
+    return true;
+}
+
+// compares the batched simulations with InterpSW and the C batch pop
+// functions with single pops, single threaded
+static int batch(const Options& options) {
+    auto start = std::chrono::steady_clock::now();
+    bool ok = true;
+    for (InterpGeneration generation : options.generations) {
+        if (generation == InterpGeneration::RP2040) {
+            ok &= check_batches<InterpGeneration::RP2040>(options);
+        } else {
+            ok &= check_batches<InterpGeneration::RP2350>(options);
+        }
+        ok &= check_c_batch(options, generation);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    printf("%llu batch runs per configuration, best isa %s, in %.3f s\n", (unsigned long long)options.batch_runs,
+        isa_name(InterpSWBatch<>::detect_isa()), std::chrono::duration<double>(end - start).count());
+    return ok ? 0 : 1;
+}
+
+// two InterpSIO with random states, each running pops on both cores at once
+// through this_core(), compared with the same pops on InterpSW. Each core may
+// only see its own interpolators, and this_core() of the other InterpSIO
+// must throw. Returns false on the first difference.
+template <InterpGeneration G>
+static bool sio_diverges(uint64_t seed, size_t length) {
+    std::mt19937 rng(seed ^ (seed >> 32));
+
+    InterpSIO<G> sio[2];
+    InterpSW<0, G> expected0[2][2];
+    InterpSW<1, G> expected1[2][2];
+    for (size_t s = 0; s < 2; s++) {
+        for (size_t c = 0; c < 2; c++) {
+            InterpState state0 = random_state(rng), state1 = random_state(rng);
+            sio[s].core[c].interp0 = expected0[s][c] = state0;
+            sio[s].core[c].interp1 = expected1[s][c] = state1;
+        }
+    }
+
+    std::vector<uint32_t> lanes(length);
+    for (uint32_t& lane : lanes) lane = rng() % 6;
+
+    // pop i of lane l < 3 is from interp0, of lane l >= 3 from interp1
+    auto pops = [&](auto& interp0, auto& interp1, std::vector<uint32_t>& out) {
+        out.resize(length);
+        for (size_t k = 0; k < length; k++) {
+            out[k] = lanes[k] < 3 ? interp0.pop(lanes[k]) : interp1.pop(lanes[k] - 3);
+        }
+    };
+
+    std::vector<uint32_t> out[2][2];
+    bool isolated = true;
+    auto work = [&](size_t s) {
+        return [&, s](typename InterpSIO<G>::Core& core) {
+            typename InterpSIO<G>::Core& own = sio[s].this_core();
+            size_t num = sio[s].get_core_num();
+            try {
+                sio[1 - s].this_core();
+                isolated = false;
+            } catch (const std::logic_error&) {}
+            if (&own != &core || &core != &sio[s].core[num]) isolated = false;
+            pops(own.interp0, own.interp1, out[s][num]);
+        };
+    };
+    std::thread other([&] { sio[1].run(work(1), work(1)); });
+    sio[0].run(work(0), work(0));
+    other.join();
+
+    try {
+        sio[0].this_core();
+        return true;
+    } catch (const std::logic_error&) {}
+    if (!isolated) return true;
+
+    for (size_t s = 0; s < 2; s++) {
+        for (size_t c = 0; c < 2; c++) {
+            std::vector<uint32_t> values;
+            pops(expected0[s][c], expected1[s][c], values);
+            if (values != out[s][c]) return true;
+            if (InterpState(sio[s].core[c].interp0) != InterpState(expected0[s][c])) return true;
+            if (InterpState(sio[s].core[c].interp1) != InterpState(expected1[s][c])) return true;
+        }
+    }
+    return false;
+}
+
+static int sio(const Options& options) {
+    auto start = std::chrono::steady_clock::now();
+    for (InterpGeneration generation : options.generations) {
+        for (uint64_t i = 0; i < options.sio_runs; i++) {
+            uint64_t seed = run_seed(options.seed, i);
+            bool mismatch = generation == InterpGeneration::RP2040
+                ? sio_diverges<InterpGeneration::RP2040>(seed, options.length)
+                : sio_diverges<InterpGeneration::RP2350>(seed, options.length);
+            if (mismatch) {
+                printf("InterpSIO on %s differs from InterpSW in run seed 0x%016llx\n", generation_name(generation), (unsigned long long)seed);
+                return 1;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    printf("%llu sio runs in %.3f s\n", (unsigned long long)options.sio_runs, std::chrono::duration<double>(end - start).count());
+    return 0;
+}
+
+static int replay(const Options& options) {
+    std::vector<Action> actions;
+    random_actions(options.seed, options.length, actions);
+
+    int result = 0;
+    for (InterpGeneration generation : options.generations) {
+        size_t index = diverges(generation, actions);
+        if (index == actions.size()) {
+            printf("%s: no mismatch\n", generation_name(generation));
+            continue;
+        }
+
+        std::vector<Action> minimal = actions;
+        minimize(generation, minimal);
+        printf("%s: mismatch at action %zu, minimal sequence (%zu actions):\n", generation_name(generation), index, minimal.size());
+        print_actions(minimal);
+        result = 1;
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    bool replay_seed = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc) return usage(argv[0]);
+
+        const char* value = argv[++i];
+        if (arg == "--threads") {
+            options.threads = std::max(1, atoi(value));
+        } else if (arg == "--seed") {
+            options.seed = strtoull(value, NULL, 0);
+        } else if (arg == "--replay") {
+            options.seed = strtoull(value, NULL, 0);
+            replay_seed = true;
+        } else if (arg == "--batch") {
+            options.batch_runs = std::max(1, atoi(value));
+        } else if (arg == "--sio") {
+            options.sio_runs = std::max(1, atoi(value));
+        } else if (arg == "--runs") {
+            options.runs = strtoull(value, NULL, 0);
+        } else if (arg == "--length") {
+            options.length = std::max(2, atoi(value));
+        } else if (arg == "--generation" && strcmp(value, "rp2040") == 0) {
+            options.generations = { InterpGeneration::RP2040 };
+        } else if (arg == "--generation" && strcmp(value, "rp2350") == 0) {
+            options.generations = { InterpGeneration::RP2350 };
+        } else if (arg == "--generation" && strcmp(value, "both") == 0) {
+            options.generations = { InterpGeneration::RP2040, InterpGeneration::RP2350 };
+        } else if (arg == "--check") {
+            options.dual = true;
+            if (strcmp(value, "every") == 0) {
+                options.policy = InterpCheckPolicy::EVERY_OP;
+            } else if (strcmp(value, "reads") == 0) {
+                options.policy = InterpCheckPolicy::READS;
+            } else if (strcmp(value, "end") == 0) {
+                options.policy = InterpCheckPolicy::END;
+            } else if (strncmp(value, "digest:", 7) == 0 && atoi(value + 7) > 0) {
+                options.policy = InterpCheckPolicy::DIGEST;
+                options.interval = atoi(value + 7);
+            } else if (atoi(value) > 0) {
+                options.policy = InterpCheckPolicy::INTERVAL;
+                options.interval = atoi(value);
+            } else {
+                return usage(argv[0]);
+            }
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    options.threads = std::max<size_t>(options.threads, 1);
+    if (options.dual) options.generations = { InterpGeneration::DEFAULT };
+    if (options.batch_runs > 0) return batch(options);
+    if (options.sio_runs > 0) return sio(options);
+    return replay_seed ? replay(options) : fuzz(options);
+}
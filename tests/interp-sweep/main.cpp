@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <interp-test.hpp>
+#include <interp-sweep.hpp>
+
+// Sweeps CTRL configurations of one lane at a time, with the other lane fixed
+// to a full mask, comparing InterpSW against InterpSWC on a set of
+// accumulator and base edge values. Only one CTRL pair per equivalence class
+// of interp_canonical_ctrl() is run.
+//
+// The sweep is split into units: generation, interpolator, swept lane,
+// special mode (blend on interpolator 0, clamp on interpolator 1) and the 21
+// lane config bits of CTRL. Units are grouped into chunks, which are the unit
+// of work of the threads and of the checkpoint.
+
+constexpr static uint32_t LANE_CONFIG_BITS = 21;
+constexpr static uint32_t BLOCK_COUNT = 16;
+constexpr static uint32_t CHUNK_BITS = 13;
+constexpr static uint32_t CHUNK_COUNT = BLOCK_COUNT << (LANE_CONFIG_BITS - CHUNK_BITS);
+
+constexpr static uint32_t PARTNER_CTRL = InterpCtrl{ .mask_lsb = 0, .mask_msb = 31 }.to();
+constexpr static uint32_t BLEND_BITS = InterpCtrl{ .blend = 1 }.to();
+constexpr static uint32_t CLAMP_BITS = InterpCtrl{ .clamp = 1 }.to();
+
+static int usage(const char* name) {
+    fprintf(stderr, "usage: %s [--threads N] [--edges small|full] [--generation rp2040|rp2350|both]\n", name);
+    fprintf(stderr, "       %*s [--checkpoint FILE] [--interval SECONDS] [--limit CHUNKS]\n", (int)strlen(name), "");
+    fprintf(stderr, "       %s --check-canonical SAMPLES [--seed SEED]\n", name);
+    return 2;
+}
+
+struct Edge {
+    uint32_t accum[2];
+    uint32_t base[3];
+};
+
+static std::vector<Edge> make_edges(bool full) {
+    constexpr static uint32_t accums[] = {
+        0x00000000, 0x00000001, 0x7fffffff, 0x80000000, 0xffffffff, 0x0000ff80, 0x12345678, 0xfedcba98,
+        0x00000080, 0x00008000, 0x0000ffff, 0x00ff00ff, 0x55555555, 0xaaaaaaaa, 0xfffffffe, 0x80000001,
+    };
+    constexpr static uint32_t bases[][3] = {
+        { 0x00000000, 0x00000000, 0x00000000 },
+        { 0x00000010, 0x00001000, 0x80000000 },
+        { 0x80000000, 0x7fffffff, 0xffffffff },
+        { 0xffffff00, 0x00000100, 0x00000001 },
+    };
+
+    size_t count = full ? std::size(accums) : std::size(accums) / 2;
+    std::vector<Edge> edges;
+    for (const auto& base : bases) {
+        for (size_t i = 0; i < count; i++) {
+            for (size_t j = 0; j < count; j++) {
+                edges.push_back({ { accums[i], accums[j] }, { base[0], base[1], base[2] } });
+            }
+        }
+    }
+    return edges;
+}
+
+struct Unit {
+    InterpGeneration generation;
+    size_t n;
+    InterpCtrlPair ctrl;
+};
+
+static Unit decode_unit(uint32_t unit) {
+    uint32_t config = unit & ((1 << LANE_CONFIG_BITS) - 1);
+    uint32_t block = unit >> LANE_CONFIG_BITS;
+    bool special = block & 1;
+    size_t lane = block >> 1 & 1;
+    size_t n = block >> 2 & 1;
+
+    Unit u = { (block >> 3) ? InterpGeneration::RP2350 : InterpGeneration::RP2040, n, { { PARTNER_CTRL, PARTNER_CTRL } } };
+    u.ctrl.ctrl[lane] = config;
+    if (special) u.ctrl.ctrl[0] |= n == 0 ? BLEND_BITS : CLAMP_BITS;
+    return u;
+}
+
+// results of one edge: state after writing it, a pop, and a BASE_1AND0 write
+struct Outcome {
+    InterpState state;
+    uint32_t pop;
+    InterpState popped;
+    InterpState based;
+
+    friend bool operator==(const Outcome&, const Outcome&) = default;
+};
+
+template <typename Interp>
+static Outcome run_edge(const InterpCtrlPair& ctrl, const Edge& edge, size_t pop) {
+    InterpState s = {};
+    s.accum[0] = edge.accum[0];
+    s.accum[1] = edge.accum[1];
+    std::copy(std::begin(edge.base), std::end(edge.base), s.base);
+    s.ctrl[0] = ctrl.ctrl[0];
+    s.ctrl[1] = ctrl.ctrl[1];
+
+    Interp intrp;
+    Outcome o;
+    intrp = s;
+    intrp.update();
+    o.state = intrp;
+    o.pop = intrp.pop(pop);
+    intrp.update();
+    o.popped = intrp;
+    intrp.base01(edge.accum[0] ^ edge.accum[1]);
+    intrp.update();
+    o.based = intrp;
+    return o;
+}
+
+struct Mismatch {
+    InterpGeneration generation;
+    size_t n;
+    InterpCtrlPair ctrl;
+    Edge edge;
+};
+
+template <InterpGeneration G, size_t N>
+static bool check_unit(const InterpCtrlPair& ctrl, std::span<const Edge> edges, Mismatch& mismatch) {
+    for (size_t e = 0; e < edges.size(); e++) {
+        Outcome sw = run_edge<InterpSW<N, G>>(ctrl, edges[e], e % 3);
+        Outcome swc = run_edge<InterpSWC<N, G>>(ctrl, edges[e], e % 3);
+        if (sw != swc) {
+            mismatch = { G, N, ctrl, edges[e] };
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool check_unit(const Unit& unit, std::span<const Edge> edges, Mismatch& mismatch) {
+    if (unit.generation == InterpGeneration::RP2040) {
+        return unit.n == 0 ? check_unit<InterpGeneration::RP2040, 0>(unit.ctrl, edges, mismatch) : check_unit<InterpGeneration::RP2040, 1>(unit.ctrl, edges, mismatch);
+    } else {
+        return unit.n == 0 ? check_unit<InterpGeneration::RP2350, 0>(unit.ctrl, edges, mismatch) : check_unit<InterpGeneration::RP2350, 1>(unit.ctrl, edges, mismatch);
+    }
+}
+
+static bool is_canonical(const Unit& unit) {
+    InterpCtrlPair canonical = unit.n == 0
+        ? interp_canonical_ctrl<0>(unit.ctrl.ctrl[0], unit.ctrl.ctrl[1])
+        : interp_canonical_ctrl<1>(unit.ctrl.ctrl[0], unit.ctrl.ctrl[1]);
+    return canonical == unit.ctrl;
+}
+
+static const char* generation_name(InterpGeneration generation) {
+    return generation == InterpGeneration::RP2040 ? "RP2040" : "RP2350";
+}
+
+static void print_mismatch(const Mismatch& m) {
+    printf("mismatch: %s interp %zu ctrl 0x%08x 0x%08x accum 0x%08x 0x%08x base 0x%08x 0x%08x 0x%08x\n",
+        generation_name(m.generation), m.n, m.ctrl.ctrl[0], m.ctrl.ctrl[1],
+        m.edge.accum[0], m.edge.accum[1], m.edge.base[0], m.edge.base[1], m.edge.base[2]);
+}
+
+// checkpoint file: header followed by one byte per chunk, 1 if done
+struct CheckpointHeader {
+    constexpr static char MAGIC[4] = { 'I', 'S', 'W', 'P' };
+    constexpr static uint16_t VERSION = 1;
+
+    char magic[4];
+    uint16_t version;
+    uint8_t full_edges;
+    uint8_t chunk_bits;
+    uint32_t chunk_count;
+    uint32_t _reserved0;
+    uint64_t classes;
+    uint64_t mismatches;
+};
+
+struct Sweep {
+    std::vector<Edge> edges;
+    bool full_edges = false;
+    bool generations[2] = { true, true };
+    std::vector<uint8_t> done = std::vector<uint8_t>(CHUNK_COUNT);
+    uint64_t classes = 0;
+    uint64_t mismatches = 0;
+    std::mutex mutex;
+
+    bool load(const char* path);
+    bool save(const char* path);
+    void run_chunk(uint32_t chunk);
+};
+
+static std::atomic<bool> interrupted = false;
+
+bool Sweep::load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return true;
+
+    CheckpointHeader header;
+    bool ok = fread(&header, sizeof header, 1, file) == 1
+        && memcmp(header.magic, CheckpointHeader::MAGIC, 4) == 0
+        && header.version == CheckpointHeader::VERSION
+        && header.full_edges == full_edges
+        && header.chunk_bits == CHUNK_BITS
+        && header.chunk_count == CHUNK_COUNT
+        && fread(done.data(), 1, done.size(), file) == done.size();
+    fclose(file);
+
+    classes = header.classes;
+    mismatches = header.mismatches;
+    return ok;
+}
+
+bool Sweep::save(const char* path) {
+    std::lock_guard lock(mutex);
+
+    CheckpointHeader header = {};
+    memcpy(header.magic, CheckpointHeader::MAGIC, 4);
+    header.version = CheckpointHeader::VERSION;
+    header.full_edges = full_edges;
+    header.chunk_bits = CHUNK_BITS;
+    header.chunk_count = CHUNK_COUNT;
+    header.classes = classes;
+    header.mismatches = mismatches;
+
+    // written next to the checkpoint and renamed, so an interrupted save
+    // keeps the previous checkpoint
+    std::string tmp = std::string(path) + ".tmp";
+    FILE* file = fopen(tmp.c_str(), "wb");
+    if (file == NULL) return false;
+
+    bool ok = fwrite(&header, sizeof header, 1, file) == 1 && fwrite(done.data(), 1, done.size(), file) == done.size();
+    ok = fclose(file) == 0 && ok;
+    return ok && rename(tmp.c_str(), path) == 0;
+}
+
+void Sweep::run_chunk(uint32_t chunk) {
+    uint64_t chunk_classes = 0;
+    uint64_t chunk_mismatches = 0;
+    std::vector<Mismatch> found;
+
+    for (uint32_t unit = chunk << CHUNK_BITS; unit < (chunk + 1) << CHUNK_BITS; unit++) {
+        Unit u = decode_unit(unit);
+        if (!is_canonical(u)) continue;
+
+        chunk_classes++;
+        Mismatch mismatch;
+        if (!check_unit(u, edges, mismatch)) {
+            chunk_mismatches++;
+            if (found.size() < 4) found.push_back(mismatch);
+        }
+    }
+
+    std::lock_guard lock(mutex);
+    for (const Mismatch& m : found) print_mismatch(m);
+    classes += chunk_classes;
+    mismatches += chunk_mismatches;
+    done[chunk] = 1;
+}
+
+struct Options {
+    size_t threads = std::thread::hardware_concurrency();
+    const char* checkpoint = NULL;
+    double interval = 60;
+    uint32_t limit = CHUNK_COUNT;
+};
+
+static int sweep(Sweep& sweep, const Options& options) {
+    if (options.checkpoint != NULL && !sweep.load(options.checkpoint)) {
+        fprintf(stderr, "%s: invalid checkpoint, or started with other --edges\n", options.checkpoint);
+        return 1;
+    }
+
+    // chunks still to do, in order
+    std::vector<uint32_t> todo;
+    for (uint32_t chunk = 0; chunk < CHUNK_COUNT; chunk++) {
+        bool rp2350 = chunk >> (LANE_CONFIG_BITS + 3 - CHUNK_BITS);
+        if (!sweep.done[chunk] && sweep.generations[rp2350]) todo.push_back(chunk);
+    }
+    if (todo.size() > options.limit) todo.resize(options.limit);
+
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> finished = 0;
+    std::atomic<size_t> running = options.threads;
+    auto worker = [&] {
+        for (size_t i; !interrupted && (i = next++) < todo.size();) {
+            sweep.run_chunk(todo[i]);
+            finished++;
+        }
+        running--;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    auto last_save = start;
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < options.threads; t++) workers.emplace_back(worker);
+
+    // saves the checkpoint every interval until all workers are done or
+    // stopped after their current chunk by SIGINT or SIGTERM
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - last_save).count() >= options.interval) {
+            last_save = now;
+            if (options.checkpoint != NULL && !sweep.save(options.checkpoint)) perror(options.checkpoint);
+            fprintf(stderr, "%zu / %zu chunks\n", finished.load(), todo.size());
+        }
+    }
+    for (std::thread& thread : workers) thread.join();
+    auto end = std::chrono::steady_clock::now();
+
+    if (options.checkpoint != NULL && !sweep.save(options.checkpoint)) {
+        perror(options.checkpoint);
+        return 1;
+    }
+
+    size_t remaining = std::count(sweep.done.begin(), sweep.done.end(), 0);
+    double seconds = std::chrono::duration<double>(end - start).count();
+    printf("%zu chunks in %.3f s, %zu of %u chunks left, %llu classes with %zu edges, %llu mismatches\n",
+        finished.load(), seconds, remaining, CHUNK_COUNT, (unsigned long long)sweep.classes, sweep.edges.size(), (unsigned long long)sweep.mismatches);
+    return sweep.mismatches ? 1 : 0;
+}
+
+// checks interp_canonical_ctrl() itself: random CTRL pairs must behave like
+// their representative on InterpSW, apart from the CTRL values read back
+template <InterpGeneration G, size_t N>
+static bool check_canonical(uint32_t ctrl0, uint32_t ctrl1, std::span<const Edge> edges, bool& reduced) {
+    InterpCtrlPair ctrl = { { ctrl0, ctrl1 } };
+    InterpCtrlPair canonical = interp_canonical_ctrl<N>(ctrl0, ctrl1);
+
+    constexpr uint32_t config_bits = 0x007fffff;
+    InterpSW<N, G> readback;
+    readback.ctrl[0] = ctrl0;
+    readback.ctrl[1] = ctrl1;
+    readback.update();
+    reduced = canonical != InterpCtrlPair{ { readback.ctrl[0] & config_bits, readback.ctrl[1] & config_bits } };
+
+    auto mask = [](Outcome o) {
+        constexpr uint32_t overf_bits = InterpCtrl{ .overf0 = 1, .overf1 = 1, .overf = 1 }.to();
+        for (InterpState* s : { &o.state, &o.popped, &o.based }) {
+            s->ctrl[0] &= overf_bits;
+            s->ctrl[1] = 0;
+        }
+        return o;
+    };
+
+    for (size_t e = 0; e < edges.size(); e++) {
+        if (mask(run_edge<InterpSW<N, G>>(ctrl, edges[e], e % 3)) != mask(run_edge<InterpSW<N, G>>(canonical, edges[e], e % 3))) {
+            printf("not equivalent: %s interp %zu ctrl 0x%08x 0x%08x canonical 0x%08x 0x%08x accum 0x%08x 0x%08x base 0x%08x 0x%08x 0x%08x\n",
+                generation_name(G), N, ctrl0, ctrl1, canonical.ctrl[0], canonical.ctrl[1],
+                edges[e].accum[0], edges[e].accum[1], edges[e].base[0], edges[e].base[1], edges[e].base[2]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static int check_canonical(uint64_t samples, uint64_t seed, std::span<const Edge> edges) {
+    std::mt19937_64 rng(seed);
+    uint64_t failures = 0;
+    uint64_t reduced = 0;
+
+    for (uint64_t i = 0; i < samples; i++) {
+        uint64_t bits = rng();
+        uint32_t ctrl0 = bits, ctrl1 = bits >> 32;
+        // every other sample in special mode
+        if (i & 1) ctrl0 |= BLEND_BITS | CLAMP_BITS;
+
+        bool ok, r;
+        switch (i >> 1 & 3) {
+            case 0: ok = check_canonical<InterpGeneration::RP2040, 0>(ctrl0, ctrl1, edges, r); break;
+            case 1: ok = check_canonical<InterpGeneration::RP2040, 1>(ctrl0, ctrl1, edges, r); break;
+            case 2: ok = check_canonical<InterpGeneration::RP2350, 0>(ctrl0, ctrl1, edges, r); break;
+            default: ok = check_canonical<InterpGeneration::RP2350, 1>(ctrl0, ctrl1, edges, r); break;
+        }
+        failures += !ok;
+        reduced += r;
+    }
+
+    printf("%llu samples, %llu reduced further than CTRL readback, %llu not equivalent\n",
+        (unsigned long long)samples, (unsigned long long)reduced, (unsigned long long)failures);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    Sweep s;
+    Options options;
+    uint64_t canonical_samples = 0;
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc) return usage(argv[0]);
+
+        const char* value = argv[++i];
+        if (arg == "--threads") {
+            options.threads = std::max(1, atoi(value));
+        } else if (arg == "--edges" && (strcmp(value, "small") == 0 || strcmp(value, "full") == 0)) {
+            s.full_edges = strcmp(value, "full") == 0;
+        } else if (arg == "--generation" && (strcmp(value, "rp2040") == 0 || strcmp(value, "rp2350") == 0 || strcmp(value, "both") == 0)) {
+            s.generations[0] = strcmp(value, "rp2350") != 0;
+            s.generations[1] = strcmp(value, "rp2040") != 0;
+        } else if (arg == "--checkpoint") {
+            options.checkpoint = value;
+        } else if (arg == "--interval") {
+            options.interval = atof(value);
+        } else if (arg == "--limit") {
+            options.limit = strtoul(value, NULL, 0);
+        } else if (arg == "--check-canonical") {
+            canonical_samples = strtoull(value, NULL, 0);
+        } else if (arg == "--seed") {
+            seed = strtoull(value, NULL, 0);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    s.edges = make_edges(s.full_edges);
+    if (canonical_samples) return check_canonical(canonical_samples, seed, s.edges);
+
+    options.threads = std::max<size_t>(options.threads, 1);
+    std::signal(SIGINT, [](int) { interrupted = true; });
+    std::signal(SIGTERM, [](int) { interrupted = true; });
+    return sweep(s, options);
+}
@@ -0,0 +1,175 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <span>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <interp-trace.hpp>
+
+static int usage(const char* name) {
+    fprintf(stderr, "usage: %s record OUT < commands\n", name);
+    fprintf(stderr, "       %s random OUT COUNT [SEED]\n", name);
+    fprintf(stderr, "       %s replay [--swc] [--repeat N] TRACE\n", name);
+    return 2;
+}
+
+static bool save(const InterpTraceRecorder& recorder, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) return false;
+
+    bool ok = recorder.write(file);
+    return fclose(file) == 0 && ok;
+}
+
+// runs text commands from stdin on InterpSW, recording them
+static int record(const char* path) {
+    InterpSWTester tester;
+    InterpTraceRecorder recorder(tester);
+
+    char line[512];
+    while (fgets(line, sizeof line, stdin) != NULL) {
+        size_t length = strlen(line);
+        if (length > 0 && line[length - 1] == '\n') length--;
+
+        std::string_view response = recorder.parse_command(std::string_view(line, length));
+        if (response.starts_with("syntax") || response.starts_with("fatal")) {
+            fprintf(stderr, "%.*s: %.*s\n", (int)length, line, (int)response.size(), response.data());
+            return 1;
+        }
+    }
+
+    if (!save(recorder, path)) {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
+
+// records random register accesses on InterpSW, mostly reads with occasional
+// writes
+static int random(const char* path, size_t count, uint32_t seed) {
+    constexpr static InterpReg writes[] = {
+        InterpReg::ACCUM0, InterpReg::ACCUM1, InterpReg::BASE0, InterpReg::BASE1, InterpReg::BASE2,
+        InterpReg::CTRL0, InterpReg::CTRL1, InterpReg::ADD0, InterpReg::ADD1, InterpReg::BASE01,
+    };
+    constexpr static InterpReg reads[] = {
+        InterpReg::POP0, InterpReg::POP1, InterpReg::POP2, InterpReg::PEEK0, InterpReg::PEEK1, InterpReg::PEEK2,
+        InterpReg::PEEKRAW0, InterpReg::PEEKRAW1, InterpReg::ACCUM0, InterpReg::ACCUM1, InterpReg::CTRL0,
+    };
+
+    std::mt19937 rng(seed);
+    InterpSWTester tester;
+    InterpTraceRecorder recorder(tester);
+    recorder.records.reserve(count);
+
+    while (recorder.records.size() < count) {
+        interp_num_t n = rng() & 1;
+        uint32_t value;
+        if (rng() % 16 == 0) {
+            InterpReg reg = writes[rng() % std::size(writes)];
+            value = rng();
+            if (reg == InterpReg::CTRL0 || reg == InterpReg::CTRL1) value &= 0x007fffff;
+            recorder.write_reg(n, reg, value);
+        } else {
+            recorder.read_reg(n, reads[rng() % std::size(reads)], value);
+        }
+    }
+
+    if (!save(recorder, path)) {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
+
+template <template <size_t N> typename Interp>
+static InterpTraceResult replay_timed(std::span<const InterpTraceRecord> records, size_t repeat, double& best) {
+    InterpTraceResult result = {};
+    best = 1e30;
+    for (size_t r = 0; r < repeat; r++) {
+        InterpTraceReplayer<Interp> replayer;
+        auto start = std::chrono::steady_clock::now();
+        result = replayer.replay(records);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return result;
+}
+
+static int replay(const char* path, bool swc, size_t repeat) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof (InterpTraceHeader)) {
+        fprintf(stderr, "%s: not a trace file\n", path);
+        close(fd);
+        return 1;
+    }
+
+    size_t size = st.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror(path);
+        return 1;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    const InterpTraceHeader* header = (const InterpTraceHeader*)data;
+    if (!header->valid() || (size - sizeof *header) % sizeof (InterpTraceRecord) != 0) {
+        fprintf(stderr, "%s: invalid trace header, version or generation\n", path);
+        munmap(data, size);
+        return 1;
+    }
+
+    std::span<const InterpTraceRecord> records((const InterpTraceRecord*)(header + 1), (size - sizeof *header) / sizeof (InterpTraceRecord));
+
+    double seconds;
+    InterpTraceResult result = swc ? replay_timed<InterpSWC>(records, repeat, seconds) : replay_timed<InterpSW>(records, repeat, seconds);
+
+    printf("%zu records in %.3f ms, %.1f Mops/s\n", result.count, seconds * 1e3, result.count / seconds / 1e6);
+    if (result.diverged) {
+        const InterpTraceRecord& record = records[result.index];
+        printf("divergence at record %zu: interp %u reg %u expected 0x%08x got 0x%08x\n",
+            result.index, record.n, record.reg, record.value, result.value);
+    }
+
+    munmap(data, size);
+    return result.diverged ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) return usage(argv[0]);
+
+    std::string_view cmd = argv[1];
+    if (cmd == "record" && argc == 3) {
+        return record(argv[2]);
+    } else if (cmd == "random" && (argc == 4 || argc == 5)) {
+        return random(argv[2], strtoull(argv[3], NULL, 0), argc == 5 ? strtoul(argv[4], NULL, 0) : 1);
+    } else if (cmd == "replay") {
+        bool swc = false;
+        size_t repeat = 1;
+        int i = 2;
+        for (; i < argc - 1; i++) {
+            if (strcmp(argv[i], "--swc") == 0) {
+                swc = true;
+            } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc - 1) {
+                repeat = std::max(1, atoi(argv[++i]));
+            } else {
+                return usage(argv[0]);
+            }
+        }
+        return replay(argv[argc - 1], swc, repeat);
+    }
+
+    return usage(argv[0]);
+}
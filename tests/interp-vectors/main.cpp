@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <interp-vector.hpp>
+
+static int usage(const char* name) {
+    fprintf(stderr, "usage: %s generate OUT COUNT [SEED]\n", name);
+    fprintf(stderr, "       %s verify [--threads N] CORPUS\n", name);
+    return 2;
+}
+
+// records random single register accesses from random states on InterpSW
+static int generate(const char* path, size_t count, uint32_t seed) {
+    constexpr static InterpReg writes[] = {
+        InterpReg::ACCUM0, InterpReg::ACCUM1, InterpReg::BASE0, InterpReg::BASE1, InterpReg::BASE2,
+        InterpReg::CTRL0, InterpReg::CTRL1, InterpReg::ADD0, InterpReg::ADD1, InterpReg::BASE01,
+    };
+
+    std::mt19937 rng(seed);
+    InterpSWTester tester;
+    std::vector<InterpVector> vectors(count);
+
+    for (InterpVector& vector : vectors) {
+        vector.n = rng() & 1;
+        vector.write = rng() & 1;
+        vector.reg = vector.write ? writes[rng() % std::size(writes)] : (InterpReg)(rng() % ((size_t)InterpReg::BASE01 + 1));
+        vector.value = rng();
+        if (vector.reg == InterpReg::CTRL0 || vector.reg == InterpReg::CTRL1) vector.value &= 0x007fffff;
+
+        InterpState& before = vector.before;
+        before = {};
+        for (uint32_t& value : before.accum) value = rng();
+        for (uint32_t& value : before.base) value = rng();
+        for (uint32_t& value : before.ctrl) value = rng() & 0x007fffff;
+        vector.record(tester);
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL || !write_vectors(file, vectors) || fclose(file) != 0) {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
+
+// same register semantics as InterpTester, directly on the C library
+static bool check_c(interp_sw_core_t& core, const interp_vector_t& vector) {
+    interp_sw_t* interp = &core.interp[vector.n];
+    interp_sw_save_t before = vector.before;
+    interp_sw_restore(interp, &before);
+    interp_sw_update(interp);
+
+    uint32_t value = vector.value;
+    if (vector.write) {
+        switch (vector.reg) {
+            case INTERP_VECTOR_REG_ACCUM0: interp->accum[0] = value; break;
+            case INTERP_VECTOR_REG_ACCUM1: interp->accum[1] = value; break;
+            case INTERP_VECTOR_REG_BASE0: interp->base[0] = value; break;
+            case INTERP_VECTOR_REG_BASE1: interp->base[1] = value; break;
+            case INTERP_VECTOR_REG_BASE2: interp->base[2] = value; break;
+            case INTERP_VECTOR_REG_CTRL0: interp->ctrl[0] = value; break;
+            case INTERP_VECTOR_REG_CTRL1: interp->ctrl[1] = value; break;
+            case INTERP_VECTOR_REG_ADD0: interp_sw_add_accumulator(interp, 0, value); break;
+            case INTERP_VECTOR_REG_ADD1: interp_sw_add_accumulator(interp, 1, value); break;
+            case INTERP_VECTOR_REG_BASE01: interp_sw_set_base_both(interp, value); break;
+            default:;
+        }
+    } else {
+        interp_sw_update(interp);
+        switch (vector.reg) {
+            case INTERP_VECTOR_REG_ACCUM0: value = interp->accum[0]; break;
+            case INTERP_VECTOR_REG_ACCUM1: value = interp->accum[1]; break;
+            case INTERP_VECTOR_REG_BASE0: value = interp->base[0]; break;
+            case INTERP_VECTOR_REG_BASE1: value = interp->base[1]; break;
+            case INTERP_VECTOR_REG_BASE2: value = interp->base[2]; break;
+            case INTERP_VECTOR_REG_CTRL0: value = interp->ctrl[0]; break;
+            case INTERP_VECTOR_REG_CTRL1: value = interp->ctrl[1]; break;
+            case INTERP_VECTOR_REG_POP0: value = interp_sw_pop_lane_result(interp, 0); break;
+            case INTERP_VECTOR_REG_POP1: value = interp_sw_pop_lane_result(interp, 1); break;
+            case INTERP_VECTOR_REG_POP2: value = interp_sw_pop_full_result(interp); break;
+            case INTERP_VECTOR_REG_PEEK0: value = interp_sw_peek_lane_result(interp, 0); break;
+            case INTERP_VECTOR_REG_PEEK1: value = interp_sw_peek_lane_result(interp, 1); break;
+            case INTERP_VECTOR_REG_PEEK2: value = interp_sw_peek_full_result(interp); break;
+            case INTERP_VECTOR_REG_PEEKRAW0: value = interp_sw_get_raw(interp, 0); break;
+            case INTERP_VECTOR_REG_PEEKRAW1: value = interp_sw_get_raw(interp, 1); break;
+            case INTERP_VECTOR_REG_ADD0: value = interp_sw_get_raw(interp, 0); break;
+            case INTERP_VECTOR_REG_ADD1: value = interp_sw_get_raw(interp, 1); break;
+            case INTERP_VECTOR_REG_BASE01: value = 0; break;
+            default:;
+        }
+    }
+
+    interp_sw_save_t after;
+    interp_sw_save(interp, &after);
+    return value == vector.value && memcmp(&after, &vector.after, sizeof after) == 0;
+}
+
+struct Shard {
+    size_t begin;
+    size_t end;
+    size_t failures_sw = 0;
+    size_t failures_c = 0;
+    size_t first = SIZE_MAX;
+};
+
+// checks vectors [begin, end) against InterpSW through the C++ reader and
+// against the C library through the C reader
+static void verify_shard(const InterpVectorFile& corpus, const interp_vector_file_t& file, Shard& shard) {
+    InterpSWTester tester;
+    interp_sw_core_t core;
+    interp_sw_core_init(&core, file.generation ? INTERP_SW_GENERATION_RP2350 : INTERP_SW_GENERATION_RP2040);
+
+    for (size_t i = shard.begin; i < shard.end; i++) {
+        bool ok_sw = corpus[i].check(tester);
+
+        interp_vector_t vector;
+        interp_vector_get(&file, i, &vector);
+        bool ok_c = check_c(core, vector);
+
+        shard.failures_sw += !ok_sw;
+        shard.failures_c += !ok_c;
+        if ((!ok_sw || !ok_c) && shard.first == SIZE_MAX) shard.first = i;
+    }
+}
+
+static int verify(const char* path, size_t threads) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "%s: not a corpus file\n", path);
+        close(fd);
+        return 1;
+    }
+
+    size_t size = st.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror(path);
+        return 1;
+    }
+
+    InterpVectorFile corpus;
+    interp_vector_file_t file;
+    if (!corpus.open(std::span((const std::byte*)data, size)) || !interp_vector_open(&file, data, size) || corpus.generation != InterpGeneration::DEFAULT) {
+        fprintf(stderr, "%s: invalid corpus header, version or generation\n", path);
+        munmap(data, size);
+        return 1;
+    }
+
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(corpus.size(), 1));
+    std::vector<Shard> shards;
+    for (size_t t = 0; t < threads; t++) {
+        shards.push_back({ corpus.size() * t / threads, corpus.size() * (t + 1) / threads });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++) {
+        workers.emplace_back(verify_shard, std::cref(corpus), std::cref(file), std::ref(shards[t]));
+    }
+    verify_shard(corpus, file, shards[0]);
+    for (std::thread& worker : workers) worker.join();
+    auto end = std::chrono::steady_clock::now();
+
+    size_t failures_sw = 0, failures_c = 0, first = SIZE_MAX;
+    for (const Shard& shard : shards) {
+        failures_sw += shard.failures_sw;
+        failures_c += shard.failures_c;
+        first = std::min(first, shard.first);
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    printf("%zu vectors on %zu threads in %.3f ms, %.1f Mvectors/s\n", corpus.size(), threads, seconds * 1e3, corpus.size() / seconds / 1e6);
+    if (first != SIZE_MAX) {
+        InterpVector vector = corpus[first];
+        printf("%zu InterpSW and %zu C library failures, first at vector %zu: interp %u %s reg %u value 0x%08x\n",
+            failures_sw, failures_c, first, vector.n, vector.write ? "write" : "read", (unsigned)vector.reg, vector.value);
+    }
+
+    munmap(data, size);
+    return first != SIZE_MAX ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) return usage(argv[0]);
+
+    std::string_view cmd = argv[1];
+    if (cmd == "generate" && (argc == 4 || argc == 5)) {
+        return generate(argv[2], strtoull(argv[3], NULL, 0), argc == 5 ? strtoul(argv[4], NULL, 0) : 1);
+    } else if (cmd == "verify") {
+        size_t threads = std::thread::hardware_concurrency();
+        int i = 2;
+        for (; i < argc - 1; i++) {
+            if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc - 1) {
+                threads = std::max(1, atoi(argv[++i]));
+            } else {
+                return usage(argv[0]);
+            }
+        }
+        return verify(argv[argc - 1], threads);
+    }
+
+    return usage(argv[0]);
+}
@@ -0,0 +1,62 @@
+#ifndef YRLF_INTERP_SWEEP_H_
+#define YRLF_INTERP_SWEEP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <interp.hpp>
+
+// CTRL pair of one interpolator, compared including OVERF flags
+struct InterpCtrlPair {
+    uint32_t ctrl[2];
+
+    friend bool operator==(const InterpCtrlPair&, const InterpCtrlPair&) = default;
+};
+
+// representative of the CTRL pairs that behave like (ctrl0, ctrl1) on
+// interpolator N, following the datapath of InterpSW::update(). All pairs with
+// the same representative give the same results, OVERF flags and writebacks
+// for any accumulator, base and BASE_1AND0 value, only the CTRL values read
+// back differ.
+template <size_t N>
+constexpr InterpCtrlPair interp_canonical_ctrl(uint32_t ctrl0_reg, uint32_t ctrl1_reg);
+
+// --- implementation ---
+
+template <size_t N>
+constexpr InterpCtrlPair interp_canonical_ctrl(uint32_t ctrl0_reg, uint32_t ctrl1_reg) {
+    InterpCtrl ctrl0 = InterpCtrl::from(ctrl0_reg);
+    InterpCtrl ctrl1 = InterpCtrl::from(ctrl1_reg);
+
+    // OVERF flags and reserved bits are read-only, blend only exists on
+    // interpolator 0 and clamp on interpolator 1, both only in CTRL0
+    ctrl0.overf0 = ctrl0.overf1 = ctrl0.overf = 0;
+    ctrl1.overf0 = ctrl1.overf1 = ctrl1.overf = 0;
+    ctrl0._reserved0 = ctrl1._reserved0 = 0;
+    ctrl0.clamp = ctrl0.clamp && N == 1;
+    ctrl0.blend = ctrl0.blend && N == 0;
+    ctrl1.clamp = ctrl1.blend = 0;
+
+    // an empty mask only depends on MSB, through the sign and OVERF bits
+    for (InterpCtrl* c : { &ctrl0, &ctrl1 }) {
+        if (c->mask_lsb > c->mask_msb) c->mask_lsb = c->mask_msb + 1;
+    }
+
+    // blend: lane 0 returns alpha, lane 1 the blend, neither adds raw or
+    // forces lane 0 bits, and BASE_1AND0 uses the sign of lane 1 for both
+    // halves, so a sign extension of the full 32 bits does nothing
+    if (ctrl0.blend) {
+        ctrl0.add_raw = 0;
+        ctrl1.add_raw = 0;
+        ctrl0.force_msb = 0;
+        if (ctrl0.mask_msb == 31) ctrl0.is_signed = 0;
+    }
+
+    // clamp: lane 0 returns the clamped raw result
+    if (ctrl0.clamp) {
+        ctrl0.add_raw = 0;
+    }
+
+    return { { ctrl0.to(), ctrl1.to() } };
+}
+
+#endif
@@ -1,6 +1,11 @@
 #ifndef YRLF_INTERP_TEST_H_
 #define YRLF_INTERP_TEST_H_
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
 #include <string_view>
 #include <stdexcept>
 #include <interp.hpp>
@@ -28,40 +33,175 @@ enum struct InterpReg {
 
 using interp_num_t = bool;
 
+// binary batch protocol: a request is an InterpBatchHeader followed by count
+// InterpBatchRecords, the response an InterpBatchResponseHeader followed by
+// words uint32_t values, all little endian. WRITE writes value to reg, READ
+// returns the value of reg, DUMP returns the 12 values of the state, DIGEST
+// returns digest() as low and high word.
+
+enum struct InterpBatchOp : uint8_t {
+    WRITE,
+    READ,
+    DUMP,
+    DIGEST,
+};
+
+enum struct InterpBatchStatus : uint8_t {
+    OK,
+    INVALID,  // invalid header or record, ops from that record on were skipped
+    FULL,     // response full, ops from that record on were skipped
+};
+
+struct InterpBatchHeader {
+    // never the first byte of a text command
+    constexpr static uint8_t SYNC = 0xb1;
+    constexpr static uint8_t VERSION = 1;
+    constexpr static size_t MAX_OPS = 1024;
+    constexpr static size_t MAX_WORDS = 4096;
+
+    uint8_t sync;
+    uint8_t version;
+    uint16_t count;
+
+    bool valid() const { return sync == SYNC && version == VERSION && count <= MAX_OPS; }
+};
+
+struct InterpBatchRecord {
+    InterpBatchOp op;
+    uint8_t reg;
+    uint8_t n;
+    uint8_t _reserved0;
+    uint32_t value;
+};
+
+struct InterpBatchResponseHeader {
+    uint8_t sync;
+    InterpBatchStatus status;
+    uint16_t count; // records run
+    uint32_t words;
+};
+
+static_assert(sizeof (InterpBatchHeader) == 4, "InterpBatchHeader has invalid layout");
+static_assert(sizeof (InterpBatchRecord) == 8, "InterpBatchRecord has invalid layout");
+static_assert(sizeof (InterpBatchResponseHeader) == 8, "InterpBatchResponseHeader has invalid layout");
+
+// rolling digest of the accesses to one interpolator, so two backends can be
+// compared with one word: state writes, register writes and register reads
+// are folded in as (op, reg, value) words, see the README
+struct InterpDigest {
+    constexpr static uint64_t INIT = 0xcbf29ce484222325;
+    constexpr static uint32_t STATE = 0;
+    constexpr static uint32_t WRITE = 1;
+    constexpr static uint32_t READ = 2;
+
+    uint64_t value = INIT;
+
+    constexpr void fold(uint32_t op, uint32_t reg, uint32_t v);
+    // the first count values of state, in dump order
+    constexpr void fold_state(const InterpState& state, size_t count);
+    // writes to read-only registers do nothing and are skipped
+    constexpr void write(InterpReg reg, uint32_t v);
+    // reads of ADD0/ADD1 are folded as PEEKRAW0/PEEKRAW1
+    constexpr void read(InterpReg reg, uint32_t v);
+    // digest of the accesses so far and the current state
+    constexpr uint64_t with_state(const InterpState& state) const;
+};
+
 struct InterpTesterBase {
     std::string_view parse_command(std::string_view cmd);
+    InterpBatchResponseHeader run_batch(std::span<const InterpBatchRecord> records, std::span<uint32_t> out);
 
     virtual void write_state(interp_num_t, const InterpState&) = 0;
     virtual void dump_state(interp_num_t, InterpState&) = 0;
     virtual void write_reg(interp_num_t, InterpReg, uint32_t) = 0;
     virtual void read_reg(interp_num_t, InterpReg, uint32_t&) = 0;
+    virtual uint64_t digest(interp_num_t) = 0;
 };
 
+// register accesses as done by InterpTester. Direct writes of accum, base
+// and ctrl set dirty, and reads call update() first only if dirty is set or
+// for CTRL0, whose overflow flags are not kept valid by lazy backends.
+template <InterpBackend Interp>
+void interp_write_reg(Interp& intrp, bool& dirty, InterpReg reg, uint32_t value);
+template <InterpBackend Interp>
+void interp_read_reg(Interp& intrp, bool& dirty, InterpReg reg, uint32_t& value);
+
+// the values of state in dump order: accum, base, ctrl, peek and peekraw.
+// The first INTERP_STATE_WRITE_VALUES are the ones a state write sets.
+constexpr size_t INTERP_STATE_VALUES = 12;
+constexpr size_t INTERP_STATE_WRITE_VALUES = 7;
+constexpr std::array<uint32_t, INTERP_STATE_VALUES> interp_state_values(const InterpState& state);
+
+// the tester API for one backend without virtual calls, for inner loops that
+// should inline the simulation. InterpTester adapts it to InterpTesterBase.
 template <template <size_t N> typename Interp = Interp>
-struct InterpTester : InterpTesterBase {
+    requires InterpBackend<Interp<0>> && InterpBackend<Interp<1>>
+struct InterpRunner {
     Interp<0> intrp0;
     Interp<1> intrp1;
+    InterpDigest digests[2];
+    bool dirty[2] = { true, true };
 
-    void write_state(interp_num_t, const InterpState&) override;
-    void dump_state(interp_num_t, InterpState&) override;
-    void write_reg(interp_num_t, InterpReg, uint32_t) override;
-    void read_reg(interp_num_t, InterpReg, uint32_t&) override;
+    void write_state(interp_num_t, const InterpState&);
+    void dump_state(interp_num_t, InterpState&);
+    void write_reg(interp_num_t, InterpReg, uint32_t);
+    void read_reg(interp_num_t, InterpReg, uint32_t&);
+    uint64_t digest(interp_num_t);
 };
 
-#if RP2040_INTERP_WITH_HARDWARE
-template <template <size_t N> typename InterpSW = InterpSW>
-struct InterpDualTester : InterpTesterBase {
-    InterpTester<InterpSW> sw;
-    InterpTester<InterpHW> hw;
+template <template <size_t N> typename Interp = Interp>
+struct InterpTester final : InterpTesterBase, InterpRunner<Interp> {
+    void write_state(interp_num_t n, const InterpState& state) override { InterpRunner<Interp>::write_state(n, state); }
+    void dump_state(interp_num_t n, InterpState& state) override { InterpRunner<Interp>::dump_state(n, state); }
+    void write_reg(interp_num_t n, InterpReg reg, uint32_t value) override { InterpRunner<Interp>::write_reg(n, reg, value); }
+    void read_reg(interp_num_t n, InterpReg reg, uint32_t& value) override { InterpRunner<Interp>::read_reg(n, reg, value); }
+    uint64_t digest(interp_num_t n) override { return InterpRunner<Interp>::digest(n); }
+};
 
-    void write_state(interp_num_t, const InterpState&) override;
-    void dump_state(interp_num_t, InterpState&) override;
-    void write_reg(interp_num_t, InterpReg, uint32_t) override;
-    void read_reg(interp_num_t, InterpReg, uint32_t&) override;
+// how often InterpDualTester compares both sides
+enum struct InterpCheckPolicy : uint8_t {
+    EVERY_OP, // read values, and the state after every register access
+    INTERVAL, // read values, and both states every interval register accesses
+    DIGEST,   // read values, and both digests every interval register accesses
+    READS,    // read values only
+    END,      // nothing until finish()
+};
+
+enum struct InterpCheckOp : uint8_t {
+    STATE,
+    WRITE,
+    READ,
+};
+
+// one access run by an InterpDualTester
+struct InterpCheckEntry {
+    uint64_t index;
+    InterpCheckOp op;
+    interp_num_t n;
+    InterpReg reg;
+    uint32_t sw_value; // value written, or read from sw
+    uint32_t hw_value; // value written, or read from hw
 };
 
+// ring buffer of the last N accesses
+template <size_t N>
+struct InterpCheckHistory {
+    std::array<InterpCheckEntry, N> entries;
+    uint64_t count = 0;
+
+    void push(const InterpCheckEntry& entry) { entries[count % N] = entry; count++; }
+    size_t size() const { return count < N ? count : N; }
+    // i-th retained entry, oldest first
+    const InterpCheckEntry& operator[](size_t i) const { return entries[(count - size() + i) % N]; }
+};
+
+// the mismatch happened in one of the accesses with an index in
+// [checked, accesses), see the history of the tester
 struct InterpDualTestFailure : std::runtime_error {
-    InterpDualTestFailure(const char* msg) : std::runtime_error(msg) {}
+    uint64_t accesses;
+    uint64_t checked;
+
+    InterpDualTestFailure(const char* msg, uint64_t accesses, uint64_t checked) : std::runtime_error(msg), accesses(accesses), checked(checked) {}
 };
 
 struct InterpDualTestStateFailure : InterpDualTestFailure {
@@ -69,20 +209,201 @@ struct InterpDualTestStateFailure : InterpDualTestFailure {
     InterpState sw_state;
     InterpState hw_state;
 
-    InterpDualTestStateFailure(interp_num_t n, const InterpState& sw, const InterpState& hw) : InterpDualTestFailure("InterpDualTest state failure"), n(n), sw_state(sw), hw_state(hw) {}
+    InterpDualTestStateFailure(interp_num_t n, const InterpState& sw, const InterpState& hw, uint64_t accesses, uint64_t checked) : InterpDualTestFailure("InterpDualTest state failure", accesses, checked), n(n), sw_state(sw), hw_state(hw) {}
 };
+
+// state is the sw state before the read with EVERY_OP, and after it
+// otherwise
 struct InterpDualTestValueFailure : InterpDualTestFailure {
     interp_num_t n;
     InterpState state;
     uint32_t sw_value;
     uint32_t hw_value;
 
-    InterpDualTestValueFailure(interp_num_t n, const InterpState& state, uint32_t sw, uint32_t hw) : InterpDualTestFailure("InterpDualTest value failure"), n(n), state(state), sw_value(sw), hw_value(hw) {}
+    InterpDualTestValueFailure(interp_num_t n, const InterpState& state, uint32_t sw, uint32_t hw, uint64_t accesses, uint64_t checked) : InterpDualTestFailure("InterpDualTest value failure", accesses, checked), n(n), state(state), sw_value(sw), hw_value(hw) {}
 };
-#endif
+
+// runs every access on sw and hw and compares them according to policy,
+// throwing InterpDualTestFailures. hw can also be a second simulator, e.g.
+// InterpDualTester<InterpSW, InterpSWC>
+template <template <size_t N> typename InterpSW = InterpSW, template <size_t N> typename InterpHW = Interp>
+struct InterpDualTester final : InterpTesterBase {
+    constexpr static size_t HISTORY = 32;
+
+    InterpRunner<InterpSW> sw;
+    InterpRunner<InterpHW> hw;
+    InterpCheckPolicy policy = InterpCheckPolicy::EVERY_OP;
+    uint64_t interval = 64;
+    InterpCheckHistory<HISTORY> history;
+    uint64_t accesses = 0;
+    uint64_t checked = 0; // accesses when both states last matched
+
+    void write_state(interp_num_t, const InterpState&) override;
+    void dump_state(interp_num_t, InterpState&) override;
+    void write_reg(interp_num_t, InterpReg, uint32_t) override;
+    void read_reg(interp_num_t, InterpReg, uint32_t&) override;
+    // compares the digests, and on mismatch the states
+    uint64_t digest(interp_num_t) override;
+
+    // compares both states, call at the end of a sequence. Throws a read
+    // mismatch deferred by the END policy first.
+    void finish();
+
+private:
+    uint64_t unchecked = 0;
+    std::optional<InterpDualTestValueFailure> deferred;
+
+    void compare_state(interp_num_t n, InterpState& state);
+    void compare_all();
+    void compare_digests();
+    void checkpoint(interp_num_t n);
+};
+
 using InterpSWTester = InterpTester<InterpSW>;
 #if RP2040_INTERP_WITH_HARDWARE
 using InterpHWTester = InterpTester<InterpHW>;
 #endif
 
+// --- implementation ---
+
+constexpr void InterpDigest::fold(uint32_t op, uint32_t reg, uint32_t v) {
+    value ^= (uint64_t)(op << 8 | reg) << 32 | v;
+    value *= 0x9e3779b97f4a7c15;
+    value ^= value >> 29;
+}
+
+constexpr void InterpDigest::fold_state(const InterpState& state, size_t count) {
+    std::array<uint32_t, INTERP_STATE_VALUES> values = interp_state_values(state);
+    for (size_t i = 0; i < count; i++) fold(STATE, i, values[i]);
+}
+
+constexpr void InterpDigest::write(InterpReg reg, uint32_t v) {
+    if (reg >= InterpReg::POP0 && reg <= InterpReg::PEEKRAW1) return;
+    fold(WRITE, (uint32_t)reg, v);
+}
+
+constexpr void InterpDigest::read(InterpReg reg, uint32_t v) {
+    if (reg == InterpReg::ADD0) reg = InterpReg::PEEKRAW0;
+    if (reg == InterpReg::ADD1) reg = InterpReg::PEEKRAW1;
+    fold(READ, (uint32_t)reg, v);
+}
+
+constexpr uint64_t InterpDigest::with_state(const InterpState& state) const {
+    InterpDigest digest = *this;
+    digest.fold_state(state, INTERP_STATE_VALUES);
+    return digest.value;
+}
+
+constexpr std::array<uint32_t, INTERP_STATE_VALUES> interp_state_values(const InterpState& state) {
+    return {
+        state.accum[0], state.accum[1],
+        state.base[0], state.base[1], state.base[2],
+        state.ctrl[0], state.ctrl[1],
+        state.peek[0], state.peek[1], state.peek[2],
+        state.peekraw[0], state.peekraw[1],
+    };
+}
+
+template <InterpBackend Interp>
+void interp_write_reg(Interp& intrp, bool& dirty, InterpReg reg, uint32_t value) {
+    switch (reg) {
+        case InterpReg::ACCUM0: intrp.accum[0] = value; dirty = true; break;
+        case InterpReg::ACCUM1: intrp.accum[1] = value; dirty = true; break;
+        case InterpReg::BASE0: intrp.base[0] = value; dirty = true; break;
+        case InterpReg::BASE1: intrp.base[1] = value; dirty = true; break;
+        case InterpReg::BASE2: intrp.base[2] = value; dirty = true; break;
+        case InterpReg::CTRL0: intrp.ctrl[0] = value; dirty = true; break;
+        case InterpReg::CTRL1: intrp.ctrl[1] = value; dirty = true; break;
+        case InterpReg::ADD0: intrp.add(0, value); break;
+        case InterpReg::ADD1: intrp.add(1, value); break;
+        case InterpReg::BASE01: intrp.base01(value); break;
+        default:;
+    }
+}
+
+template <InterpBackend Interp>
+void interp_read_reg(Interp& intrp, bool& dirty, InterpReg reg, uint32_t& value) {
+    if (dirty || reg == InterpReg::CTRL0) {
+        intrp.update();
+        dirty = false;
+    }
+
+    switch (reg) {
+        case InterpReg::ACCUM0: value = intrp.accum[0]; break;
+        case InterpReg::ACCUM1: value = intrp.accum[1]; break;
+        case InterpReg::BASE0: value = intrp.base[0]; break;
+        case InterpReg::BASE1: value = intrp.base[1]; break;
+        case InterpReg::BASE2: value = intrp.base[2]; break;
+        case InterpReg::CTRL0: value = intrp.ctrl[0]; break;
+        case InterpReg::CTRL1: value = intrp.ctrl[1]; break;
+        case InterpReg::POP0: value = intrp.pop(0); break;
+        case InterpReg::POP1: value = intrp.pop(1); break;
+        case InterpReg::POP2: value = intrp.pop(2); break;
+        case InterpReg::PEEK0: value = intrp.peek(0); break;
+        case InterpReg::PEEK1: value = intrp.peek(1); break;
+        case InterpReg::PEEK2: value = intrp.peek(2); break;
+        case InterpReg::PEEKRAW0: value = intrp.peekraw(0); break;
+        case InterpReg::PEEKRAW1: value = intrp.peekraw(1); break;
+        case InterpReg::ADD0: value = intrp.peekraw(0); break;
+        case InterpReg::ADD1: value = intrp.peekraw(1); break;
+        case InterpReg::BASE01: value = intrp.read_base01(); break;
+        default:;
+    }
+}
+
+template <template <size_t N> typename Interp>
+    requires InterpBackend<Interp<0>> && InterpBackend<Interp<1>>
+void InterpRunner<Interp>::write_state(interp_num_t n, const InterpState& state) {
+    digests[n].fold_state(state, INTERP_STATE_WRITE_VALUES);
+    if (n == 0) {
+        intrp0 = state;
+    } else {
+        intrp1 = state;
+    }
+    dirty[n] = true;
+}
+
+template <template <size_t N> typename Interp>
+    requires InterpBackend<Interp<0>> && InterpBackend<Interp<1>>
+void InterpRunner<Interp>::dump_state(interp_num_t n, InterpState& state) {
+    if (n == 0) {
+        intrp0.update();
+        intrp0.save(state);
+    } else {
+        intrp1.update();
+        intrp1.save(state);
+    }
+    dirty[n] = false;
+}
+
+template <template <size_t N> typename Interp>
+    requires InterpBackend<Interp<0>> && InterpBackend<Interp<1>>
+void InterpRunner<Interp>::write_reg(interp_num_t n, InterpReg reg, uint32_t value) {
+    digests[n].write(reg, value);
+    if (n == 0) {
+        interp_write_reg(intrp0, dirty[0], reg, value);
+    } else {
+        interp_write_reg(intrp1, dirty[1], reg, value);
+    }
+}
+
+template <template <size_t N> typename Interp>
+    requires InterpBackend<Interp<0>> && InterpBackend<Interp<1>>
+void InterpRunner<Interp>::read_reg(interp_num_t n, InterpReg reg, uint32_t& value) {
+    if (n == 0) {
+        interp_read_reg(intrp0, dirty[0], reg, value);
+    } else {
+        interp_read_reg(intrp1, dirty[1], reg, value);
+    }
+    digests[n].read(reg, value);
+}
+
+template <template <size_t N> typename Interp>
+    requires InterpBackend<Interp<0>> && InterpBackend<Interp<1>>
+uint64_t InterpRunner<Interp>::digest(interp_num_t n) {
+    InterpState state;
+    dump_state(n, state);
+    return digests[n].with_state(state);
+}
+
 #endif
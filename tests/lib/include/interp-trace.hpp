@@ -0,0 +1,80 @@
+#ifndef YRLF_INTERP_TRACE_H_
+#define YRLF_INTERP_TRACE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <vector>
+#include <interp-test.hpp>
+
+// binary trace file: one InterpTraceHeader, followed by InterpTraceRecords
+// until the end of the file, all little endian
+
+enum struct InterpTraceOp : uint8_t {
+    WRITE,
+    READ,
+    READ_EXPECT,
+};
+
+struct InterpTraceHeader {
+    constexpr static char MAGIC[4] = { 'I', 'T', 'R', 'C' };
+    constexpr static uint16_t VERSION = 1;
+
+    char magic[4];
+    uint16_t version;
+    uint8_t generation;
+    uint8_t _reserved0;
+
+    // header for traces of the default InterpGeneration
+    static InterpTraceHeader current();
+    bool valid() const;
+};
+
+struct InterpTraceRecord {
+    InterpTraceOp op;
+    uint8_t reg;
+    uint8_t n;
+    uint8_t _reserved0;
+    uint32_t value;
+};
+
+static_assert(sizeof (InterpTraceHeader) == 8, "InterpTraceHeader has invalid layout");
+static_assert(sizeof (InterpTraceRecord) == 8, "InterpTraceRecord has invalid layout");
+
+// forwards every access to target, recording it together with the value read
+// as expected result
+struct InterpTraceRecorder : InterpTesterBase {
+    InterpTesterBase& target;
+    std::vector<InterpTraceRecord> records;
+
+    explicit InterpTraceRecorder(InterpTesterBase& target) : target(target) {}
+
+    void write_state(interp_num_t, const InterpState&) override;
+    void dump_state(interp_num_t, InterpState&) override;
+    void write_reg(interp_num_t, InterpReg, uint32_t) override;
+    void read_reg(interp_num_t, InterpReg, uint32_t&) override;
+    // not recorded
+    uint64_t digest(interp_num_t n) override { return target.digest(n); }
+
+    bool write(FILE* file) const;
+};
+
+struct InterpTraceResult {
+    size_t count;
+    bool diverged;
+    size_t index;   // first record that read a different value than expected
+    uint32_t value; // value read by that record
+};
+
+// runs a trace without going through InterpTesterBase, stopping at the first
+// divergence
+template <template <size_t N> typename Interp = Interp>
+struct InterpTraceReplayer {
+    Interp<0> intrp0;
+    Interp<1> intrp1;
+
+    InterpTraceResult replay(std::span<const InterpTraceRecord> records);
+};
+
+#endif
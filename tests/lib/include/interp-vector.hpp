@@ -0,0 +1,40 @@
+#ifndef YRLF_INTERP_VECTOR_H_
+#define YRLF_INTERP_VECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <vector>
+#include <interp-test.hpp>
+#include <interp_vector.h>
+
+// one test vector, see <interp_vector.h> for the corpus format
+struct InterpVector {
+    interp_num_t n;
+    InterpReg reg;
+    bool write;
+    uint32_t value;
+    InterpState before;
+    InterpState after;
+
+    // runs the vector on tester, filling in value (for reads) and after
+    void record(InterpTesterBase& tester);
+    // runs the vector on tester, false if value or after differ
+    bool check(InterpTesterBase& tester) const;
+};
+
+// read-only view of a corpus in memory
+struct InterpVectorFile {
+    uint64_t count = 0;
+    InterpGeneration generation = InterpGeneration::DEFAULT;
+    std::span<const uint32_t> columns[INTERP_VECTOR_COLUMN_COUNT];
+
+    bool open(std::span<const std::byte> data);
+    size_t size() const { return count; }
+    InterpVector operator[](size_t i) const;
+};
+
+bool write_vectors(FILE* file, std::span<const InterpVector> vectors);
+
+#endif
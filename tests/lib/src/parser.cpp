@@ -245,6 +245,15 @@ std::string_view format_data_reg(uint32_t value) {
     return result_buffer;
 }
 
+std::string_view format_data_digest(uint64_t value) {
+    buf_writer writer(result_buffer);
+
+    if (!writer.write_field("data")) return fail_str;
+    if (!writer.write_int_hex(value)) return fail_str;
+
+    return result_buffer;
+}
+
 std::string_view format_data_state(const InterpState& state) {
     buf_writer writer(result_buffer);
 
@@ -288,6 +297,52 @@ std::string_view format_diff_state(const InterpState& state, const InterpState&
     return result_buffer;
 }
 
+InterpBatchResponseHeader InterpTesterBase::run_batch(std::span<const InterpBatchRecord> records, std::span<uint32_t> out) {
+    InterpBatchResponseHeader response = { InterpBatchHeader::SYNC, InterpBatchStatus::OK, 0, 0 };
+
+    for (const InterpBatchRecord& record : records) {
+        if (record.n > 1 || record.reg > (uint8_t)InterpReg::BASE01) {
+            response.status = InterpBatchStatus::INVALID;
+            break;
+        }
+
+        interp_num_t n = record.n;
+        InterpReg reg = (InterpReg)record.reg;
+        if (record.op == InterpBatchOp::WRITE) {
+            write_reg(n, reg, record.value);
+        } else if (record.op == InterpBatchOp::READ) {
+            if (out.size() - response.words < 1) {
+                response.status = InterpBatchStatus::FULL;
+                break;
+            }
+            read_reg(n, reg, out[response.words++]);
+        } else if (record.op == InterpBatchOp::DUMP) {
+            if (out.size() - response.words < INTERP_STATE_VALUES) {
+                response.status = InterpBatchStatus::FULL;
+                break;
+            }
+            InterpState state;
+            dump_state(n, state);
+            for (uint32_t value : interp_state_values(state)) out[response.words++] = value;
+        } else if (record.op == InterpBatchOp::DIGEST) {
+            if (out.size() - response.words < 2) {
+                response.status = InterpBatchStatus::FULL;
+                break;
+            }
+            uint64_t value = digest(n);
+            out[response.words++] = (uint32_t)value;
+            out[response.words++] = (uint32_t)(value >> 32);
+        } else {
+            response.status = InterpBatchStatus::INVALID;
+            break;
+        }
+
+        response.count++;
+    }
+
+    return response;
+}
+
 #define OK "ok"
 #define SYNTAX_ERROR(msg) ("syntax '" msg "'")
 #ifdef RP2040_INTERP_GENERATION_RP2350
@@ -336,6 +391,8 @@ std::string_view InterpTesterBase::parse_command(std::string_view cmdline) {
             read_reg(n, reg, read_value);
             if (value != read_value) return format_diff_reg(value, read_value);
         }
+    } else if (cmd == "digest") {
+        return format_data_digest(digest(n));
     } else if (cmd == "generation") {
         return GENERATION;
     } else {
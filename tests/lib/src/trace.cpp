@@ -0,0 +1,99 @@
+#include <cstring>
+#include <interp-trace.hpp>
+
+template struct InterpTraceReplayer<InterpSW>;
+template struct InterpTraceReplayer<InterpSWC>;
+
+InterpTraceHeader InterpTraceHeader::current() {
+    InterpTraceHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof MAGIC);
+    header.version = VERSION;
+    header.generation = InterpGeneration::DEFAULT == InterpGeneration::RP2350;
+    return header;
+}
+
+bool InterpTraceHeader::valid() const {
+    return memcmp(magic, MAGIC, sizeof MAGIC) == 0 && version == VERSION && generation == current().generation;
+}
+
+// registers in the order of InterpState
+constexpr static InterpReg state_regs[] = {
+    InterpReg::ACCUM0,
+    InterpReg::ACCUM1,
+    InterpReg::BASE0,
+    InterpReg::BASE1,
+    InterpReg::BASE2,
+    InterpReg::CTRL0,
+    InterpReg::CTRL1,
+    InterpReg::PEEK0,
+    InterpReg::PEEK1,
+    InterpReg::PEEK2,
+    InterpReg::PEEKRAW0,
+    InterpReg::PEEKRAW1,
+};
+
+static_assert(std::size(state_regs) == INTERP_STATE_VALUES, "state_regs does not match interp_state_values()");
+
+void InterpTraceRecorder::write_state(interp_num_t n, const InterpState& state) {
+    target.write_state(n, state);
+
+    std::array<uint32_t, INTERP_STATE_VALUES> values = interp_state_values(state);
+    for (size_t i = 0; i < INTERP_STATE_WRITE_VALUES; i++) {
+        records.push_back({ InterpTraceOp::WRITE, (uint8_t)state_regs[i], n, 0, values[i] });
+    }
+}
+
+void InterpTraceRecorder::dump_state(interp_num_t n, InterpState& state) {
+    target.dump_state(n, state);
+
+    std::array<uint32_t, INTERP_STATE_VALUES> values = interp_state_values(state);
+    for (size_t i = 0; i < std::size(state_regs); i++) {
+        records.push_back({ InterpTraceOp::READ_EXPECT, (uint8_t)state_regs[i], n, 0, values[i] });
+    }
+}
+
+void InterpTraceRecorder::write_reg(interp_num_t n, InterpReg reg, uint32_t value) {
+    target.write_reg(n, reg, value);
+    records.push_back({ InterpTraceOp::WRITE, (uint8_t)reg, n, 0, value });
+}
+
+void InterpTraceRecorder::read_reg(interp_num_t n, InterpReg reg, uint32_t& value) {
+    target.read_reg(n, reg, value);
+    records.push_back({ InterpTraceOp::READ_EXPECT, (uint8_t)reg, n, 0, value });
+}
+
+bool InterpTraceRecorder::write(FILE* file) const {
+    InterpTraceHeader header = InterpTraceHeader::current();
+    if (fwrite(&header, sizeof header, 1, file) != 1) return false;
+    return fwrite(records.data(), sizeof (InterpTraceRecord), records.size(), file) == records.size();
+}
+
+// same register semantics as InterpTester
+template <typename Interp>
+static inline bool replay_record(Interp& intrp, bool& dirty, const InterpTraceRecord& record, uint32_t& value) {
+    if (record.op == InterpTraceOp::WRITE) {
+        value = record.value;
+        interp_write_reg(intrp, dirty, (InterpReg)record.reg, value);
+        return true;
+    }
+
+    value = 0;
+    interp_read_reg(intrp, dirty, (InterpReg)record.reg, value);
+    return record.op != InterpTraceOp::READ_EXPECT || value == record.value;
+}
+
+template <template <size_t N> typename Interp>
+InterpTraceResult InterpTraceReplayer<Interp>::replay(std::span<const InterpTraceRecord> records) {
+    bool dirty0 = true;
+    bool dirty1 = true;
+
+    for (size_t i = 0; i < records.size(); i++) {
+        const InterpTraceRecord& record = records[i];
+
+        uint32_t value;
+        bool ok = record.n ? replay_record(intrp1, dirty1, record, value) : replay_record(intrp0, dirty0, record, value);
+        if (!ok) return { i + 1, true, i, value };
+    }
+
+    return { records.size(), false, 0, 0 };
+}
@@ -0,0 +1,82 @@
+#include <cstring>
+#include <interp-vector.hpp>
+
+void InterpVector::record(InterpTesterBase& tester) {
+    tester.write_state(n, before);
+    if (write) {
+        tester.write_reg(n, reg, value);
+    } else {
+        tester.read_reg(n, reg, value);
+    }
+    tester.dump_state(n, after);
+}
+
+bool InterpVector::check(InterpTesterBase& tester) const {
+    InterpVector result = *this;
+    result.record(tester);
+    return result.value == value && result.after == after;
+}
+
+bool InterpVectorFile::open(std::span<const std::byte> data) {
+    interp_vector_file_t file;
+    if (!interp_vector_open(&file, data.data(), data.size())) return false;
+
+    count = file.count;
+    generation = file.generation ? InterpGeneration::RP2350 : InterpGeneration::RP2040;
+    for (size_t i = 0; i < INTERP_VECTOR_COLUMN_COUNT; i++) {
+        columns[i] = std::span(file.columns[i], count);
+    }
+    return true;
+}
+
+InterpVector InterpVectorFile::operator[](size_t i) const {
+    uint32_t op = columns[INTERP_VECTOR_COLUMN_OP][i];
+    uint32_t before[INTERP_VECTOR_STATE_COLUMNS], after[INTERP_VECTOR_STATE_COLUMNS];
+    for (size_t k = 0; k < INTERP_VECTOR_STATE_COLUMNS; k++) {
+        before[k] = columns[INTERP_VECTOR_COLUMN_BEFORE + k][i];
+        after[k] = columns[INTERP_VECTOR_COLUMN_AFTER + k][i];
+    }
+
+    InterpVector vector;
+    vector.n = op & INTERP_VECTOR_OP_N_BITS;
+    vector.write = op & INTERP_VECTOR_OP_WRITE_BITS;
+    vector.reg = (InterpReg)((op & INTERP_VECTOR_OP_REG_BITS) >> INTERP_VECTOR_OP_REG_LSB);
+    vector.value = columns[INTERP_VECTOR_COLUMN_VALUE][i];
+    memcpy(&vector.before, before, sizeof before);
+    memcpy(&vector.after, after, sizeof after);
+    return vector;
+}
+
+bool write_vectors(FILE* file, std::span<const InterpVector> vectors) {
+    static_assert(sizeof (InterpState) == INTERP_VECTOR_STATE_COLUMNS * sizeof (uint32_t), "InterpState has invalid layout");
+
+    interp_vector_header_t header = {};
+    memcpy(header.magic, "IVEC", 4);
+    header.version = INTERP_VECTOR_VERSION;
+    header.generation = InterpGeneration::DEFAULT == InterpGeneration::RP2350;
+    header.column_count = INTERP_VECTOR_COLUMN_COUNT;
+    header.count = vectors.size();
+    if (fwrite(&header, sizeof header, 1, file) != 1) return false;
+
+    std::vector<uint32_t> column(vectors.size());
+    for (size_t c = 0; c < INTERP_VECTOR_COLUMN_COUNT; c++) {
+        for (size_t i = 0; i < vectors.size(); i++) {
+            const InterpVector& vector = vectors[i];
+            uint32_t before[INTERP_VECTOR_STATE_COLUMNS], after[INTERP_VECTOR_STATE_COLUMNS];
+            memcpy(before, &vector.before, sizeof before);
+            memcpy(after, &vector.after, sizeof after);
+
+            if (c == INTERP_VECTOR_COLUMN_OP) {
+                column[i] = (vector.n ? INTERP_VECTOR_OP_N_BITS : 0) | (vector.write ? INTERP_VECTOR_OP_WRITE_BITS : 0) | ((uint32_t)vector.reg << INTERP_VECTOR_OP_REG_LSB);
+            } else if (c == INTERP_VECTOR_COLUMN_VALUE) {
+                column[i] = vector.value;
+            } else if (c < INTERP_VECTOR_COLUMN_AFTER) {
+                column[i] = before[c - INTERP_VECTOR_COLUMN_BEFORE];
+            } else {
+                column[i] = after[c - INTERP_VECTOR_COLUMN_AFTER];
+            }
+        }
+        if (fwrite(column.data(), sizeof (uint32_t), column.size(), file) != column.size()) return false;
+    }
+    return true;
+}
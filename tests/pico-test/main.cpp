@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <cstdint>
 #include <cstdio>
+#include <span>
 #include <string_view>
 #include <pico/stdio_usb.h>
 #include <interp-test.hpp>
@@ -9,13 +12,19 @@
 
 static char line_buffer[512];
 
-std::string_view getline() {
+static int getchar_blocking() {
+    while (true) {
+        int c = getchar_timeout_us(1000);
+        if (c != PICO_ERROR_TIMEOUT) return c;
+    }
+}
+
+// reads the rest of a text command starting with c
+std::string_view getline(int c) {
     size_t i = 0;
     size_t length = sizeof line_buffer;
 
-    while (true) {
-        int c = getchar_timeout_us(1000);
-        if (c == PICO_ERROR_TIMEOUT) continue;
+    for (;; c = getchar_blocking()) {
         if (c == '\n' || c == '\r') break;
         if ((c == '\b' || c == '\x7f') && i > 0) {
             i--;
@@ -31,12 +40,59 @@ std::string_view getline() {
     return std::string_view(line_buffer, i);
 }
 
+static void read_bytes(void* data, size_t size) {
+    uint8_t* out = (uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        out[i] = getchar_blocking();
+    }
+}
+
+// without CRLF translation
+static void write_bytes(const void* data, size_t size) {
+    const uint8_t* in = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        putchar_raw(in[i]);
+    }
+}
+
+static InterpBatchRecord batch_records[InterpBatchHeader::MAX_OPS];
+static uint32_t batch_words[InterpBatchHeader::MAX_WORDS];
+
+// reads the rest of a binary batch after its sync byte and writes its response
+static void run_batch(InterpTesterBase& tester) {
+    InterpBatchHeader header = { InterpBatchHeader::SYNC, 0, 0 };
+    read_bytes((uint8_t*)&header + 1, sizeof header - 1);
+
+    InterpBatchResponseHeader response = { InterpBatchHeader::SYNC, InterpBatchStatus::INVALID, 0, 0 };
+    if (header.count <= InterpBatchHeader::MAX_OPS) {
+        read_bytes(batch_records, header.count * sizeof (InterpBatchRecord));
+        if (header.valid()) response = tester.run_batch(std::span(batch_records, header.count), batch_words);
+    } else {
+        // skip the records of an oversized batch, so the next frame is in sync
+        for (size_t left = header.count; left > 0;) {
+            size_t n = std::min<size_t>(left, InterpBatchHeader::MAX_OPS);
+            read_bytes(batch_records, n * sizeof (InterpBatchRecord));
+            left -= n;
+        }
+    }
+
+    write_bytes(&response, sizeof response);
+    write_bytes(batch_words, response.words * sizeof (uint32_t));
+    stdio_flush();
+}
+
 int main() {
     stdio_usb_init();
 
     InterpTester<INTERP_TYPE> tester;
     while (true) {
-        std::string_view command = getline();
+        int c = getchar_blocking();
+        if (c == InterpBatchHeader::SYNC) {
+            run_batch(tester);
+            continue;
+        }
+
+        std::string_view command = getline(c);
         std::string_view response = tester.parse_command(command);
         puts(response.data());
     }